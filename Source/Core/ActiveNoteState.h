@@ -0,0 +1,72 @@
+//
+//  ActiveNoteState.h
+//  MidiSender
+//
+//  16 x 128 table of held notes and their velocities. Not synchronised:
+//  OscEngine updates it as notes are sent and copies it for snapshots, both
+//  on the sender thread under its lock.
+//
+
+#pragma once
+
+#include "MidiEvent.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace midisender
+{
+
+class ActiveNoteState {
+public:
+    static constexpr int numChannels = 16;
+    static constexpr int numNotes = 128;
+    static constexpr int numSlots = numChannels * numNotes;
+
+    struct Snapshot {
+        std::array<uint64_t, numSlots / 64> bits {};
+        std::array<uint8_t, numSlots> velocities {};
+
+        /** channel is 0-based here. */
+        bool isActive(int channel, int note) const {
+            const auto slot = size_t(channel * numNotes + note);
+            return (bits[slot / 64] >> (slot % 64)) & 1;
+        }
+
+        uint8_t getVelocity(int channel, int note) const { return velocities[size_t(channel * numNotes + note)]; }
+
+        int getNumActive() const {
+            int count = 0;
+            for (auto word : bits)
+                count += __builtin_popcountll(word);
+            return count;
+        }
+    };
+
+    void apply(const MidiEvent& event) {
+        if (event.isNoteOn())
+            set(event.channel - 1, event.data1, event.data2);
+        else if (event.type == MidiEvent::Type::noteOff)
+            set(event.channel - 1, event.data1, 0);
+    }
+
+    void reset() { _state = {}; }
+
+    void read(Snapshot& snapshot) const { snapshot = _state; }
+
+private:
+    void set(int channel, int note, uint8_t velocity) {
+        if (channel < 0 || channel >= numChannels)
+            return;
+
+        const auto slot = size_t(channel * numNotes + (note & 0x7f));
+        const uint64_t bit = uint64_t(1) << (slot % 64);
+        _state.bits[slot / 64] = velocity > 0 ? (_state.bits[slot / 64] | bit) : (_state.bits[slot / 64] & ~bit);
+        _state.velocities[slot] = velocity;
+    }
+
+    Snapshot _state;
+};
+
+} // namespace midisender
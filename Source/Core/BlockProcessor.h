@@ -0,0 +1,93 @@
+//
+//  BlockProcessor.h
+//  MidiSender
+//
+//  The per-block path of OscSenderAudioProcessor::process() without the JUCE
+//  buffers, shared with the headless soak runner so both exercise the same
+//  code. Every message is transformed in place, then notes and SysEx are
+//  queued on the engine. With a load generator set, synthetic events follow
+//  the block's own and the block time goes to the soak monitor.
+//
+//      processor.beginBlock(context);      // first thing in the block
+//      processor.setParameterValue(...);   // once per macro
+//      processor.processMessage(...);      // every incoming message
+//      processor.endBlock(numSamples);
+//
+
+#pragma once
+
+#include "LoadGenerator.h"
+#include "MidiTransform.h"
+#include "OscEngine.h"
+#include "SoakMonitor.h"
+
+#include <chrono>
+
+namespace midisender
+{
+
+class BlockProcessor {
+public:
+    BlockProcessor(OscEngine& engine, MidiTransformStage& transform)
+        : _engine(engine), _transform(transform) {}
+
+    /** Call before the first block. Either may be null. */
+    void setSoakTest(LoadGenerator* generator, SoakMonitor* monitor) {
+        _generator = generator;
+        _monitor = monitor;
+    }
+
+    /** Audio thread, first in the block so its whole duration is measured. */
+    void beginBlock(const BlockContext& context) {
+        _blockStart = std::chrono::steady_clock::now();
+        _sampleRate = context.sampleRate;
+        _transform.beginBlock();
+        _engine.beginBlock(context);
+    }
+
+    /** Audio thread, once per streamed parameter and block after beginBlock(). */
+    void setParameterValue(int index, float value) {
+        _engine.setParameterValue(index, value);
+    }
+
+    /** Audio thread. Rewrites a channel message in place, so whatever else
+        reads the bytes afterwards sees the transformed event. Notes and SysEx
+        go out over OSC, everything else is only forwarded. */
+    void processMessage(uint8_t* bytes, int size, int samplePosition) {
+        if (size <= 3)
+            _transform.process(bytes, size);
+        const auto event = MidiEvent::fromBytes(bytes, size, samplePosition);
+        if (event.isNote())
+            _engine.pushEvent(event);
+        else if (size > 1 && bytes[0] == 0xf0)
+            _engine.pushSysEx(bytes, size, samplePosition);
+    }
+
+    /** Audio thread. Adds the generator's events for the block and records its time. */
+    void endBlock(int numSamples) {
+        if (_generator != nullptr)
+            _generator->generate(numSamples, _sampleRate, [this](uint8_t* bytes, int size, int samplePosition) {
+                processMessage(bytes, size, samplePosition);
+            });
+        if (_monitor != nullptr)
+            _monitor->recordBlock(std::chrono::steady_clock::now() - _blockStart);
+    }
+
+    /** Audio thread, between beginBlock() and endBlock(). Releases the generator's held notes. */
+    void releaseGeneratedNotes(int samplePosition) {
+        if (_generator != nullptr)
+            _generator->releaseAll(samplePosition, [this](uint8_t* bytes, int size, int position) {
+                processMessage(bytes, size, position);
+            });
+    }
+
+private:
+    OscEngine& _engine;
+    MidiTransformStage& _transform;
+    LoadGenerator* _generator = nullptr;
+    SoakMonitor* _monitor = nullptr;
+    std::chrono::steady_clock::time_point _blockStart;
+    double _sampleRate = 44100.0;
+};
+
+} // namespace midisender
@@ -0,0 +1,136 @@
+//
+//  ClockSync.cpp
+//  MidiSender
+//
+
+#include "ClockSync.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace midisender
+{
+
+namespace
+{
+/** Samples are accepted up to this much slower than the quickest recent one. */
+constexpr double delayTolerance = 1.5;
+constexpr double delayMargin = 0.0002;
+
+bool endsWith(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+}
+
+//==============================================================================
+void ClockEstimator::reset() {
+    *this = ClockEstimator();
+}
+
+bool ClockEstimator::addSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4) {
+    const double delay = oscTimeTagDifference(t4, t1) - oscTimeTagDifference(t3, t2);
+    if (delay < 0.0 || oscTimeTagDifference(t4, t1) < 0.0)
+        return false;
+
+    _delays[_nextDelay] = delay;
+    _nextDelay = (_nextDelay + 1) % delayWindowSize;
+    _numDelays = std::min(_numDelays + 1, delayWindowSize);
+
+    const double minimumDelay = getMinimumDelay();
+    if (delay > minimumDelay * delayTolerance + delayMargin)
+        return false;
+
+    if (_numPoints == 0)
+        _epoch = t1;
+
+    // The offset is measured at the midpoint of the exchange on the local clock.
+    const double offset = (oscTimeTagDifference(t2, t1) + oscTimeTagDifference(t3, t4)) / 2.0;
+    const double time = (oscTimeTagDifference(t1, _epoch) + oscTimeTagDifference(t4, _epoch)) / 2.0;
+    _points[_nextPoint] = { time, offset };
+    _nextPoint = (_nextPoint + 1) % maxHistory;
+    _numPoints = std::min(_numPoints + 1, maxHistory);
+
+    fit();
+    return true;
+}
+
+double ClockEstimator::getMinimumDelay() const {
+    if (_numDelays == 0)
+        return 0.0;
+    return *std::min_element(_delays.begin(), _delays.begin() + (long) _numDelays);
+}
+
+void ClockEstimator::fit() {
+    double meanTime = 0.0, meanOffset = 0.0;
+    for (size_t i = 0; i < _numPoints; ++i) {
+        meanTime += _points[i].time;
+        meanOffset += _points[i].offset;
+    }
+    meanTime /= (double) _numPoints;
+    meanOffset /= (double) _numPoints;
+
+    double covariance = 0.0, variance = 0.0;
+    for (size_t i = 0; i < _numPoints; ++i) {
+        covariance += (_points[i].time - meanTime) * (_points[i].offset - meanOffset);
+        variance += (_points[i].time - meanTime) * (_points[i].time - meanTime);
+    }
+
+    // Over less than a second the slope is mostly jitter.
+    _drift = variance > 0.0 && _numPoints >= 3 && variance / (double) _numPoints > 0.25
+                 ? std::clamp(covariance / variance, -maxDrift, maxDrift)
+                 : 0.0;
+    _intercept = meanOffset - _drift * meanTime;
+}
+
+double ClockEstimator::getOffset(uint64_t localTimeTag) const {
+    if (_numPoints == 0)
+        return 0.0;
+    return _intercept + _drift * oscTimeTagDifference(localTimeTag, _epoch);
+}
+
+uint64_t ClockEstimator::toRemote(uint64_t localTimeTag) const {
+    return oscTimeTagAddSeconds(localTimeTag, getOffset(localTimeTag));
+}
+
+//==============================================================================
+ClockResponder::ClockResponder() : _buffer(1536), _writer(256), _start(std::chrono::system_clock::now()) {}
+
+void ClockResponder::simulateClockError(double offsetSeconds, double drift) {
+    _start = std::chrono::system_clock::now();
+    _offset = offsetSeconds;
+    _drift = drift;
+}
+
+uint64_t ClockResponder::now() const {
+    const auto systemNow = std::chrono::system_clock::now();
+    const double elapsed = std::chrono::duration<double>(systemNow - _start).count();
+    return oscTimeTagAddSeconds(oscTimeTagFromSystemTime(systemNow), _offset + _drift * elapsed);
+}
+
+bool ClockResponder::answerPending(int timeoutMs, const OscPacketReader::MessageCallback& onOtherMessage) {
+    UdpEndpoint source;
+    const int size = _socket.receive(_buffer.data(), _buffer.size(), timeoutMs, source);
+    if (size <= 0)
+        return false;
+    const auto receiveTime = now();
+
+    bool answered = false;
+    OscPacketReader::parse(_buffer.data(), (size_t) size, [&](const OscMessageView& message, uint64_t timeTag) {
+        uint64_t t1;
+        if (! endsWith(message.address, "/clock/ping") || ! message.getTimeTag(0, t1)) {
+            if (onOtherMessage)
+                onOtherMessage(message, timeTag);
+            return;
+        }
+
+        std::string address(message.address);
+        address.replace(address.size() - 4, 4, "pong");
+        _writer.reset();
+        if (_writer.beginMessage(address, "ttt") && _writer.addTimeTag(t1) && _writer.addTimeTag(receiveTime)
+            && _writer.addTimeTag(now()) && _writer.endMessage())
+            answered = _socket.sendTo(source, _writer.data(), _writer.size());
+    });
+    return answered;
+}
+
+} // namespace midisender
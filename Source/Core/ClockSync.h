@@ -0,0 +1,121 @@
+//
+//  ClockSync.h
+//  MidiSender
+//
+//  NTP style clock comparison with a destination, so absolute bundle timetags
+//  can be written in the receiver's time. The sender pings with its send time
+//  t1; the receiver answers with t1, its receive time t2 and its reply time t3;
+//  the sender notes the arrival time t4:
+//
+//      /<mainId>/clock/ping  t        (t1)
+//      /<mainId>/clock/pong  t t t    (t1, t2, t3)
+//
+//  All times are OSC (NTP format) timetags.
+//
+
+#pragma once
+
+#include "OscPacket.h"
+#include "UdpTransport.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace midisender
+{
+
+/** Turns ping/pong samples into an offset and drift estimate.
+
+    Samples whose round trip took much longer than the quickest recent one
+    were delayed asymmetrically by queuing and are rejected. The accepted ones
+    feed a least squares line through (local time, offset), whose slope is
+    the drift between the two clocks. */
+class ClockEstimator {
+public:
+    static constexpr size_t delayWindowSize = 8;
+    static constexpr size_t maxHistory = 16;
+    static constexpr double maxDrift = 500.0e-6;   // crystal clocks stay well inside this
+
+    void reset();
+
+    /** Returns false if the sample was rejected. */
+    bool addSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4);
+
+    bool hasEstimate() const { return _numPoints > 0; }
+
+    /** Remote minus local clock in seconds at the given local time. */
+    double getOffset(uint64_t localTimeTag) const;
+
+    /** Remote clock rate relative to the local one, e.g. 20e-6 = 20 ppm fast. */
+    double getDrift() const { return _drift; }
+
+    /** Round trip of the quickest recent exchange, in seconds. */
+    double getMinimumDelay() const;
+
+    /** Converts a local timetag to the remote clock. Unchanged without an estimate. */
+    uint64_t toRemote(uint64_t localTimeTag) const;
+
+private:
+    void fit();
+
+    struct Point {
+        double time;     // seconds since _epoch on the local clock
+        double offset;   // seconds
+    };
+
+    uint64_t _epoch = 0;
+    std::array<double, delayWindowSize> _delays {};
+    size_t _numDelays = 0;
+    size_t _nextDelay = 0;
+    std::array<Point, maxHistory> _points {};
+    size_t _numPoints = 0;
+    size_t _nextPoint = 0;
+    double _intercept = 0.0;
+    double _drift = 0.0;
+};
+
+/** Stand-in for a receiver: answers clock pings on a UDP port, optionally
+    with a simulated clock offset and drift. Used by the tests, and a
+    starting point for receivers that want to support clock sync. */
+class ClockResponder {
+public:
+    ClockResponder();
+
+    bool bind(int port) { return _socket.bind(port); }
+    int getBoundPort() const { return _socket.getBoundPort(); }
+
+    /** Makes this responder's clock run `offsetSeconds` ahead of the system
+        clock, gaining `drift` seconds per second from now on. */
+    void simulateClockError(double offsetSeconds, double drift);
+
+    /** Waits up to timeoutMs for a datagram and answers it if it is a ping.
+        Other messages are passed to `onOtherMessage` if set. Returns true if
+        a ping was answered. */
+    bool answerPending(int timeoutMs, const OscPacketReader::MessageCallback& onOtherMessage = nullptr);
+
+    /** The responder's (possibly simulated) clock. */
+    uint64_t now() const;
+
+private:
+    UdpReceiver _socket;
+    std::vector<uint8_t> _buffer;
+    OscPacketWriter _writer;
+    std::chrono::system_clock::time_point _start;
+    double _offset = 0.0;
+    double _drift = 0.0;
+};
+
+/** Seconds from b to a, for timetags no more than 68 years apart. */
+inline double oscTimeTagDifference(uint64_t a, uint64_t b) {
+    return double(int64_t(a - b)) / 4294967296.0;
+}
+
+inline uint64_t oscTimeTagAddSeconds(uint64_t timeTag, double seconds) {
+    return timeTag + uint64_t(int64_t(seconds * 4294967296.0));
+}
+
+} // namespace midisender
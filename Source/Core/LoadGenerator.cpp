@@ -0,0 +1,124 @@
+//
+//  LoadGenerator.cpp
+//  MidiSender
+//
+
+#include "LoadGenerator.h"
+
+#include <cstdlib>
+#include <sstream>
+
+namespace midisender
+{
+
+namespace
+{
+bool parseNumber(const std::string& text, double minimum, double maximum, double& value) {
+    if (text.empty())
+        return false;
+    char* end = nullptr;
+    const double parsed = std::strtod(text.c_str(), &end);
+    if (*end != 0 || parsed < minimum || parsed > maximum)
+        return false;
+    value = parsed;
+    return true;
+}
+
+bool parseInt(const std::string& text, int minimum, int maximum, int& value) {
+    double parsed;
+    if (! parseNumber(text, minimum, maximum, parsed) || parsed != (int) parsed)
+        return false;
+    value = (int) parsed;
+    return true;
+}
+
+bool parseMix(const std::string& text, LoadSettings& settings) {
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const auto colon = item.find(':');
+        if (colon == std::string::npos)
+            return false;
+        const auto type = item.substr(0, colon);
+        int* weight = type == "notes"      ? &settings.noteWeight
+                    : type == "cc"         ? &settings.controllerWeight
+                    : type == "bend"       ? &settings.pitchBendWeight
+                    : type == "pressure"   ? &settings.pressureWeight
+                    : type == "sysex"      ? &settings.sysExWeight
+                                           : nullptr;
+        if (weight == nullptr || ! parseInt(item.substr(colon + 1), 0, 1000, *weight))
+            return false;
+    }
+    return true;
+}
+
+bool parsePair(const std::string& key, const std::string& value, LoadSettings& settings) {
+    if (key == "rate")
+        return parseNumber(value, 0.0, 100000.0, settings.eventsPerSecond);
+    if (key == "chord")
+        return parseInt(value, 1, LoadGenerator::maxChordSize, settings.chordSize);
+    if (key == "length")
+        return parseNumber(value, 1.0, 60000.0, settings.noteLengthMs);
+    if (key == "sweep")
+        return parseNumber(value, 0.0, 100.0, settings.sweepHz);
+    if (key == "cc")
+        return parseInt(value, 0, 119, settings.sweepController);
+    if (key == "channels")
+        return parseInt(value, 1, 16, settings.channels);
+    if (key == "sysex")
+        return parseInt(value, 3, LoadGenerator::maxSysExSize, settings.sysExSize);
+    if (key == "mix")
+        return parseMix(value, settings);
+    if (key == "seed") {
+        int seed;
+        if (! parseInt(value, 1, 0x7fffffff, seed))
+            return false;
+        settings.seed = (uint32_t) seed;
+        return true;
+    }
+    return false;
+}
+}
+
+bool parseLoadSettings(std::string_view text, LoadSettings& settings, std::string& error) {
+    std::stringstream stream { std::string(text) };
+    std::string pair;
+    while (stream >> pair) {
+        const auto equals = pair.find('=');
+        if (equals == std::string::npos || ! parsePair(pair.substr(0, equals), pair.substr(equals + 1), settings)) {
+            error = pair;
+            return false;
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+LoadGenerator::LoadGenerator(const LoadSettings& settings) {
+    setSettings(settings);
+}
+
+void LoadGenerator::setSettings(const LoadSettings& settings) {
+    _settings = settings;
+    _settings.chordSize = std::clamp(_settings.chordSize, 1, maxChordSize);
+    _settings.channels = std::clamp(_settings.channels, 1, 16);
+    _totalWeight = _settings.noteWeight + _settings.controllerWeight + _settings.pitchBendWeight
+                 + _settings.pressureWeight + _settings.sysExWeight;
+
+    _sysEx.assign(_settings.sysExWeight > 0 ? (size_t) std::clamp(_settings.sysExSize, 3, maxSysExSize) : 0, 0);
+    if (! _sysEx.empty()) {
+        _sysEx.front() = 0xf0;
+        _sysEx.back() = 0xf7;
+    }
+
+    _random = _settings.seed != 0 ? _settings.seed : 1;
+    _sampleTime = 0;
+    _eventBudget = 0.0;
+    _sweepPhase = 0.0;
+    _lastSweepValue = 0xff;
+    _noteOffTime.fill(-1);
+    _numHeld = 0;
+    _sysExCount = 0;
+}
+
+} // namespace midisender
@@ -0,0 +1,191 @@
+//
+//  LoadGenerator.h
+//  MidiSender
+//
+//  Synthetic MIDI for soak tests. Produces a steady stream of chords, random
+//  controllers, pitch bends, channel pressure and SysEx dumps in a chosen mix,
+//  plus an optional triangle sweep on one controller. Every note-on gets its
+//  note-off after the configured length, so the held-note table stays bounded
+//  however long it runs. generate() never allocates or blocks.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace midisender
+{
+
+struct LoadSettings {
+    double eventsPerSecond = 200.0;   // picks from the mix below, a chord counts once
+    int chordSize = 3;                // notes per chord, stacked thirds
+    double noteLengthMs = 250.0;
+    double sweepHz = 0.5;             // triangle sweep on sweepController, 0 = off
+    int sweepController = 1;
+    int channels = 1;                 // events are spread over channels 1..channels
+    int sysExSize = 256;              // bytes per dump, F0 and F7 included
+
+    // Relative weights of the message types
+    int noteWeight = 6;
+    int controllerWeight = 3;
+    int pitchBendWeight = 1;
+    int pressureWeight = 0;
+    int sysExWeight = 0;
+
+    uint32_t seed = 1;
+};
+
+/** Parses whitespace separated key=value pairs, e.g.
+        "rate=500 chord=4 length=100 sweep=2 cc=74 channels=4
+         mix=notes:6,cc:3,bend:1,pressure:0,sysex:1 sysex=1024 seed=7"
+    Keys that are left out keep their defaults. Returns false and names the
+    first bad pair in error. */
+bool parseLoadSettings(std::string_view text, LoadSettings& settings, std::string& error);
+
+class LoadGenerator {
+public:
+    static constexpr int maxChordSize = 16;
+    static constexpr int maxSysExSize = 16 * 1024;
+
+    explicit LoadGenerator(const LoadSettings& settings = {});
+
+    /** Call before generating starts; forgets held notes without releasing them. */
+    void setSettings(const LoadSettings& settings);
+    const LoadSettings& getSettings() const { return _settings; }
+
+    /** Audio thread. Calls emit(uint8_t* bytes, int size, int samplePosition)
+        for every message of the next block. The bytes may be rewritten in
+        place but are only valid during the call. Messages come in groups
+        (note-offs, sweep, then the new events) rather than strictly sorted
+        by position. */
+    template <typename EmitFunction>
+    void generate(int numSamples, double sampleRate, EmitFunction&& emit) {
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return;
+        const auto blockEnd = _sampleTime + numSamples;
+
+        if (_numHeld > 0) {
+            for (size_t i = 0; i < _noteOffTime.size(); ++i) {
+                if (_noteOffTime[i] < 0 || _noteOffTime[i] >= blockEnd)
+                    continue;
+                const int position = int(std::max<int64_t>(0, _noteOffTime[i] - _sampleTime));
+                _noteOffTime[i] = -1;
+                --_numHeld;
+                emitShort(emit, uint8_t(0x80 | (i >> 7)), uint8_t(i & 0x7f), 0, position);
+            }
+        }
+
+        if (_settings.sweepHz > 0.0) {
+            _sweepPhase += _settings.sweepHz * numSamples / sampleRate;
+            _sweepPhase -= (int) _sweepPhase;
+            const auto value = uint8_t((_sweepPhase < 0.5 ? _sweepPhase * 2.0 : 2.0 - _sweepPhase * 2.0) * 127.0 + 0.5);
+            if (value != _lastSweepValue) {
+                _lastSweepValue = value;
+                emitShort(emit, 0xb0, uint8_t(_settings.sweepController), value, 0);
+            }
+        }
+
+        _eventBudget += _settings.eventsPerSecond * numSamples / sampleRate;
+        const int count = (int) _eventBudget;
+        _eventBudget -= count;
+        for (int i = 0; i < count; ++i) {
+            const int position = int(int64_t(i) * numSamples / count);
+            emitEvent(emit, position, sampleRate);
+        }
+
+        _sampleTime = blockEnd;
+    }
+
+    /** Audio thread. Releases every held note at `samplePosition`. */
+    template <typename EmitFunction>
+    void releaseAll(int samplePosition, EmitFunction&& emit) {
+        for (size_t i = 0; i < _noteOffTime.size() && _numHeld > 0; ++i) {
+            if (_noteOffTime[i] < 0)
+                continue;
+            _noteOffTime[i] = -1;
+            --_numHeld;
+            emitShort(emit, uint8_t(0x80 | (i >> 7)), uint8_t(i & 0x7f), 0, samplePosition);
+        }
+    }
+
+    int getNumHeldNotes() const { return _numHeld; }
+
+    /** Messages generated so far. Safe to read from any thread. */
+    uint64_t getNumGenerated() const { return _numGenerated.load(std::memory_order_relaxed); }
+
+private:
+    uint32_t nextRandom() {
+        // xorshift32
+        _random ^= _random << 13;
+        _random ^= _random >> 17;
+        _random ^= _random << 5;
+        return _random;
+    }
+
+    int nextInt(int range) { return range > 1 ? int(nextRandom() % uint32_t(range)) : 0; }
+
+    template <typename EmitFunction>
+    void emitShort(EmitFunction& emit, uint8_t status, uint8_t data1, uint8_t data2, int position) {
+        _message = { status, data1, data2 };
+        emit(_message.data(), (status & 0xf0) == 0xd0 ? 2 : 3, position);
+        _numGenerated.store(_numGenerated.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    template <typename EmitFunction>
+    void emitEvent(EmitFunction& emit, int position, double sampleRate) {
+        const auto channel = uint8_t(nextInt(_settings.channels));
+        int choice = nextInt(_totalWeight);
+
+        if ((choice -= _settings.noteWeight) < 0) {
+            static constexpr int thirds[maxChordSize] = { 0, 4, 7, 11, 14, 17, 21, 24, 28, 31, 35, 38, 41, 45, 48, 52 };
+            const int root = 36 + nextInt(49);
+            const auto noteOff = _sampleTime + position + int64_t(_settings.noteLengthMs * 0.001 * sampleRate);
+            for (int i = 0; i < _settings.chordSize && root + thirds[i] < 128; ++i) {
+                const int note = root + thirds[i];
+                auto& held = _noteOffTime[size_t((channel << 7) | note)];
+                if (held >= 0)
+                    continue;
+                held = noteOff;
+                ++_numHeld;
+                emitShort(emit, uint8_t(0x90 | channel), uint8_t(note), uint8_t(1 + nextInt(127)), position);
+            }
+        } else if ((choice -= _settings.controllerWeight) < 0) {
+            emitShort(emit, uint8_t(0xb0 | channel), uint8_t(nextInt(120)), uint8_t(nextInt(128)), position);
+        } else if ((choice -= _settings.pitchBendWeight) < 0) {
+            const int bend = nextInt(16384);
+            emitShort(emit, uint8_t(0xe0 | channel), uint8_t(bend & 0x7f), uint8_t(bend >> 7), position);
+        } else if ((choice -= _settings.pressureWeight) < 0) {
+            emitShort(emit, uint8_t(0xd0 | channel), uint8_t(nextInt(128)), 0, position);
+        } else if (! _sysEx.empty()) {
+            // The payload changes with every dump so receivers cannot dedupe them
+            for (size_t i = 1; i + 1 < _sysEx.size(); ++i)
+                _sysEx[i] = uint8_t((_sysExCount + i) & 0x7f);
+            _sysEx[1] = 0x7d;   // non-commercial manufacturer ID
+            ++_sysExCount;
+            emit(_sysEx.data(), (int) _sysEx.size(), position);
+            _numGenerated.store(_numGenerated.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    LoadSettings _settings;
+    int _totalWeight = 0;
+    uint32_t _random = 1;
+    int64_t _sampleTime = 0;
+    double _eventBudget = 0.0;
+    double _sweepPhase = 0.0;
+    uint8_t _lastSweepValue = 0xff;
+    std::array<int64_t, 16 * 128> _noteOffTime;   // sample time of the note-off, -1 = not held
+    int _numHeld = 0;
+    std::array<uint8_t, 3> _message {};
+    std::vector<uint8_t> _sysEx;
+    uint32_t _sysExCount = 0;
+    std::atomic<uint64_t> _numGenerated { 0 };
+};
+
+} // namespace midisender
@@ -0,0 +1,81 @@
+//
+//  MidiEvent.h
+//  MidiSender
+//
+//  Plain MIDI event model shared by the realtime core and the plugin.
+//  Trivially copyable so it can travel through lock-free queues.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace midisender
+{
+
+struct MidiEvent
+{
+    enum class Type : uint8_t {
+        noteOn,
+        noteOff,
+        controlChange,
+        programChange,
+        pitchBend,
+        channelPressure,
+        aftertouch,
+        sysEx,
+        other,
+        parameter     // a streamed parameter value rendered offline, not MIDI
+    };
+
+    Type type = Type::other;
+    uint8_t channel = 1;      // 1..16, same convention as juce::MidiMessage::getChannel()
+    uint8_t data1 = 0;        // note / controller / program number
+    uint8_t data2 = 0;        // velocity / controller value / pressure
+    uint8_t route = 0;        // output route picked by the RoutingTable, 0 = default
+    bool isOffline = false;   // rendered while the host was running non-realtime
+    bool startsRender = false;   // the first event queued in a new offline render
+    uint16_t routing = 0;     // generation of the RoutingTable that picked route
+    int32_t samplePosition = 0;
+    uint32_t sysExPosition = 0;   // sysEx only: where the payload sits in the engine's SysExPool
+    uint32_t sysExSize = 0;       // sysEx only: payload size, F0 and F7 included
+    float value = 0.0f;           // parameter only: the value, data1 holds the index
+    double time = 0.0;        // song position in seconds
+
+    bool isNote() const { return type == Type::noteOn || type == Type::noteOff; }
+    bool isNoteOn() const { return type == Type::noteOn; }
+    bool isSysEx() const { return type == Type::sysEx; }
+    bool isParameter() const { return type == Type::parameter; }
+    float getFloatVelocity() const { return data2 * (1.0f / 127.0f); }
+
+    /** Decodes a short MIDI message from its raw bytes.
+        A note-on with zero velocity is reported as a note-off, like JUCE does. */
+    static MidiEvent fromBytes(const uint8_t* bytes, int numBytes, int samplePosition) {
+        MidiEvent event;
+        event.samplePosition = samplePosition;
+        if (numBytes < 1 || bytes[0] < 0x80 || bytes[0] >= 0xf0)
+            return event;
+
+        const uint8_t status = bytes[0] & 0xf0;
+        event.channel = (uint8_t) ((bytes[0] & 0x0f) + 1);
+        event.data1 = numBytes > 1 ? (uint8_t) (bytes[1] & 0x7f) : 0;
+        event.data2 = numBytes > 2 ? (uint8_t) (bytes[2] & 0x7f) : 0;
+
+        switch (status) {
+            case 0x90: event.type = event.data2 > 0 ? Type::noteOn : Type::noteOff; break;
+            case 0x80: event.type = Type::noteOff; break;
+            case 0xa0: event.type = Type::aftertouch; break;
+            case 0xb0: event.type = Type::controlChange; break;
+            case 0xc0: event.type = Type::programChange; break;
+            case 0xd0: event.type = Type::channelPressure; break;
+            case 0xe0: event.type = Type::pitchBend; break;
+            default: break;
+        }
+        return event;
+    }
+};
+
+static_assert(std::is_trivially_copyable<MidiEvent>::value, "MidiEvent must stay trivially copyable");
+
+} // namespace midisender
@@ -0,0 +1,131 @@
+//
+//  MidiOscEncoder.cpp
+//  MidiSender
+//
+
+#include "MidiOscEncoder.h"
+#include "OscDefaults.h"
+
+namespace midisender
+{
+
+MidiOscEncoder::MidiOscEncoder() {
+    setMainId(DEFAULT_OSC_MAIN_ID);
+}
+
+void MidiOscEncoder::setMainId(std::string_view mainId) {
+    _mainId = std::string(mainId);
+    _root = "/" + _mainId;
+    _syncAddress = _root + "/sync";
+    _noteStateAddress = _root + "/noteState";
+    _sysExAddress = _root + "/sysex";
+    _clockPingAddress = _root + "/clock/ping";
+    _clockPongAddress = _root + "/clock/pong";
+
+    // Address and type tags are padded to 4 bytes, then three ints and the blob size.
+    const size_t headerSize = ((_sysExAddress.size() + 4) & ~size_t(3)) + 8 + 4 * 4;
+    _sysExFragmentCapacity = headerSize < maxDatagramSize ? (maxDatagramSize - headerSize) & ~size_t(3) : 0;
+
+    const std::string noteRoot = _root + "/midiNote/";
+    for (size_t i = 0; i < _noteAddresses.size(); ++i) {
+        const auto identifier = std::to_string(i);
+        _noteAddresses[i].number = noteRoot + "number/" + identifier;
+        _noteAddresses[i].velocity = noteRoot + "velocity/" + identifier;
+        _noteAddresses[i].onOff = noteRoot + "onOff/" + identifier;
+    }
+    buildParameterAddresses();
+}
+
+void MidiOscEncoder::setParameterNames(const std::vector<std::string>& names) {
+    _parameterNames = names;
+    buildParameterAddresses();
+}
+
+void MidiOscEncoder::buildParameterAddresses() {
+    _parameterAddresses.clear();
+    for (const auto& name : _parameterNames)
+        _parameterAddresses.push_back(_root + "/param/" + name);
+}
+
+bool MidiOscEncoder::encodeNote(const MidiEvent& event, OscPacketWriter& writer, uint64_t timeTag) const {
+    if (! event.isNote())
+        return false;
+
+    const auto& addresses = _noteAddresses[event.data1 & 0x7f];
+    writer.reset();
+    return writer.beginBundle(timeTag)
+        && writer.beginMessage(addresses.number, "i") && writer.addInt32(event.data1) && writer.endMessage()
+        && writer.beginMessage(addresses.velocity, "f") && writer.addFloat32(event.getFloatVelocity()) && writer.endMessage()
+        && writer.beginMessage(addresses.onOff, "i") && writer.addInt32(event.isNoteOn() ? 1 : 0) && writer.endMessage();
+}
+
+bool MidiOscEncoder::encodeValue(std::string_view name, float value, OscPacketWriter& writer) const {
+    std::string address;
+    address.reserve(_root.size() + 1 + name.size());
+    address.append(_root).append("/").append(name);
+    return writeValue(address, value, writer);
+}
+
+bool MidiOscEncoder::encodeParameter(size_t index, float value, OscPacketWriter& writer, uint64_t timeTag) const {
+    if (index >= _parameterAddresses.size())
+        return false;
+    if (timeTag == oscTimeTagImmediately)
+        return writeValue(_parameterAddresses[index], value, writer);
+
+    writer.reset();
+    return writer.beginBundle(timeTag)
+        && writer.beginMessage(_parameterAddresses[index], "f") && writer.addFloat32(value) && writer.endMessage();
+}
+
+bool MidiOscEncoder::writeValue(std::string_view address, float value, OscPacketWriter& writer) {
+    writer.reset();
+    return writer.beginMessage(address, "f") && writer.addFloat32(value) && writer.endMessage();
+}
+
+bool MidiOscEncoder::encodeSysExHeader(uint32_t messageId, int index, int count, size_t fragmentSize, OscPacketWriter& writer) const {
+    writer.reset();
+    return writer.beginMessage(_sysExAddress, "iiib")
+        && writer.addInt32(int32_t(messageId)) && writer.addInt32(index) && writer.addInt32(count)
+        && writer.addInt32(int32_t(fragmentSize));   // the blob size word
+}
+
+bool MidiOscEncoder::encodeSysExFragment(uint32_t messageId, int index, int count, const uint8_t* data, size_t size, OscPacketWriter& writer) const {
+    writer.reset();
+    return writer.beginMessage(_sysExAddress, "iiib")
+        && writer.addInt32(int32_t(messageId)) && writer.addInt32(index) && writer.addInt32(count)
+        && writer.addBlob(data, size) && writer.endMessage();
+}
+
+bool MidiOscEncoder::encodeClockPing(uint64_t sendTime, OscPacketWriter& writer) const {
+    writer.reset();
+    return writer.beginMessage(_clockPingAddress, "t") && writer.addTimeTag(sendTime) && writer.endMessage();
+}
+
+bool MidiOscEncoder::encodeNoteState(const ActiveNoteState::Snapshot& snapshot, OscPacketWriter& writer) const {
+    const int numActive = snapshot.getNumActive();
+
+    writer.reset();
+    if (! writer.beginMessage(_noteStateAddress, "ib") || ! writer.addInt32(numActive))
+        return false;
+
+    auto* blob = writer.addBlobSpace(noteStateBitmapSize + (size_t) numActive);
+    if (blob == nullptr)
+        return false;
+
+    // Emitting each bitmap word low byte first gives the byte/bit layout documented in the header.
+    auto* velocities = blob + noteStateBitmapSize;
+    for (size_t word = 0; word < snapshot.bits.size(); ++word) {
+        auto bits = snapshot.bits[word];
+        for (size_t b = 0; b < 8; ++b)
+            blob[word * 8 + b] = uint8_t(bits >> (b * 8));
+
+        while (bits != 0) {
+            const int slot = int(word * 64) + __builtin_ctzll(bits);
+            *velocities++ = snapshot.velocities[(size_t) slot];
+            bits &= bits - 1;
+        }
+    }
+    return writer.endMessage();
+}
+
+} // namespace midisender
@@ -0,0 +1,107 @@
+//
+//  MidiOscEncoder.h
+//  MidiSender
+//
+//  Turns MidiEvents into OSC packets. Every address is prebuilt when the main
+//  ID changes, so encoding an event is a handful of memcpys into the writer.
+//
+
+#pragma once
+
+#include "ActiveNoteState.h"
+#include "MidiEvent.h"
+#include "OscPacket.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace midisender
+{
+
+class MidiOscEncoder {
+public:
+    MidiOscEncoder();
+
+    /** Rebuilds the address table. Not realtime safe. */
+    void setMainId(std::string_view mainId);
+    const std::string& getMainId() const { return _mainId; }
+
+    /** Writes the note bundle:
+            /<mainId>/midiNote/number/<n>    i  note number
+            /<mainId>/midiNote/velocity/<n>  f  velocity 0..1
+            /<mainId>/midiNote/onOff/<n>     i  1 = on, 0 = off
+        Returns false for non-note events or if the packet does not fit. */
+    bool encodeNote(const MidiEvent& event, OscPacketWriter& writer, uint64_t timeTag = oscTimeTagImmediately) const;
+
+    /** Writes /<mainId>/<name> with a single float argument. */
+    bool encodeValue(std::string_view name, float value, OscPacketWriter& writer) const;
+
+    /** Prebuilds /<mainId>/param/<name> for each streamed parameter. Not realtime safe. */
+    void setParameterNames(const std::vector<std::string>& names);
+
+    /** Writes /<mainId>/param/<name>  f  for the parameter at `index`, inside
+        a bundle when a timetag is given. Returns false if the index has no name. */
+    bool encodeParameter(size_t index, float value, OscPacketWriter& writer, uint64_t timeTag = oscTimeTagImmediately) const;
+
+    /** Writes /<mainId>/noteState  i b  (number of held notes, state blob).
+        The blob is a 256 byte bitmap, 16 bytes per channel with bit (n % 8) of
+        byte (n / 8) set for held note n, followed by one velocity byte for each
+        set bit in channel then note order. */
+    bool encodeNoteState(const ActiveNoteState::Snapshot& snapshot, OscPacketWriter& writer) const;
+
+    /** SysEx travels as one or more datagrams, each no larger than maxDatagramSize:
+            /<mainId>/sysex  i i i b  (message ID, fragment index, fragment count, bytes)
+        Joining the blobs of fragments 0 to count - 1 gives the whole message,
+        F0 and F7 included. Returns how many message bytes fit in one fragment. */
+    size_t getSysExFragmentCapacity() const { return _sysExFragmentCapacity; }
+
+    /** Writes a fragment up to and including its blob size. The caller sends the
+        fragment bytes and getBlobPadding() zero bytes right after the header,
+        so the message itself is never copied into the writer. */
+    bool encodeSysExHeader(uint32_t messageId, int index, int count, size_t fragmentSize, OscPacketWriter& writer) const;
+
+    /** Writes a complete fragment, bytes included. */
+    bool encodeSysExFragment(uint32_t messageId, int index, int count, const uint8_t* data, size_t size, OscPacketWriter& writer) const;
+
+    static size_t getBlobPadding(size_t size) { return (4 - (size & 3)) & 3; }
+
+    /** Writes /<mainId>/clock/ping  t  (the local send time), see ClockSync.h. */
+    bool encodeClockPing(uint64_t sendTime, OscPacketWriter& writer) const;
+
+    /** True for the /<mainId>/clock/pong a receiver answers a ping with. */
+    bool isClockPong(std::string_view address) const { return address == _clockPongAddress; }
+
+    /** True for the /<mainId>/sync query receivers send to ask for a snapshot. */
+    bool isSyncRequest(std::string_view address) const { return address == _syncAddress; }
+
+    static constexpr size_t noteStateBitmapSize = ActiveNoteState::numSlots / 8;
+
+    /** 1500 byte Ethernet MTU minus the IPv4 and UDP headers. */
+    static constexpr size_t maxDatagramSize = 1472;
+
+private:
+    void buildParameterAddresses();
+    static bool writeValue(std::string_view address, float value, OscPacketWriter& writer);
+
+    struct NoteAddresses {
+        std::string number;
+        std::string velocity;
+        std::string onOff;
+    };
+
+    std::string _mainId;
+    std::string _root;
+    std::string _syncAddress;
+    std::string _noteStateAddress;
+    std::string _sysExAddress;
+    std::string _clockPingAddress;
+    std::string _clockPongAddress;
+    size_t _sysExFragmentCapacity = 0;
+    std::array<NoteAddresses, 128> _noteAddresses;
+    std::vector<std::string> _parameterNames;
+    std::vector<std::string> _parameterAddresses;
+};
+
+} // namespace midisender
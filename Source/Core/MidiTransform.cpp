@@ -0,0 +1,87 @@
+//
+//  MidiTransform.cpp
+//  MidiSender
+//
+
+#include "MidiTransform.h"
+
+#include <algorithm>
+
+namespace midisender
+{
+
+MidiTransformTables MidiTransformTables::compile(const MidiTransformSettings& settings) {
+    MidiTransformTables tables;
+
+    const int low = std::clamp(std::min(settings.lowKey, settings.highKey), 0, 127);
+    const int high = std::clamp(std::max(settings.lowKey, settings.highKey), 0, 127);
+    for (int n = 0; n < 128; ++n) {
+        int note = n + settings.transpose;
+        while (note < low && note + 12 <= high)
+            note += 12;
+        while (note > high && note - 12 >= low)
+            note -= 12;
+        tables.note[(size_t) n] = uint8_t(std::clamp(note, low, high));
+    }
+
+    switch (settings.velocityCurve) {
+        case VelocityCurve::linear: tables.velocity = curves::linear; break;
+        case VelocityCurve::soft:   tables.velocity = curves::soft; break;
+        case VelocityCurve::hard:   tables.velocity = curves::hard; break;
+        case VelocityCurve::fixed:  tables.velocity = curves::fixed; break;
+    }
+
+    for (int c = 0; c < 16; ++c)
+        tables.channel[(size_t) c] = uint8_t(settings.outputChannel >= 1 && settings.outputChannel <= 16 ? settings.outputChannel - 1 : c);
+
+    return tables;
+}
+
+//==============================================================================
+MidiTransformStage::MidiTransformStage() {
+    setSettings({});
+}
+
+void MidiTransformStage::setSettings(const MidiTransformSettings& settings) {
+    _exchange.publish(std::make_unique<MidiTransformTables>(MidiTransformTables::compile(settings)));
+}
+
+void MidiTransformStage::reset() {
+    _heldNote.fill(0);
+    _heldChannel.fill(0);
+}
+
+void MidiTransformStage::process(uint8_t* bytes, int numBytes) {
+    if (_tables == nullptr || numBytes < 1 || bytes[0] < 0x80 || bytes[0] >= 0xf0)
+        return;
+
+    const uint8_t status = bytes[0] & 0xf0;
+    const uint8_t inChannel = bytes[0] & 0x0f;
+    uint8_t outChannel = _tables->channel[inChannel];
+
+    if ((status == 0x90 || status == 0x80 || status == 0xa0) && numBytes >= 3) {
+        const size_t slot = size_t(inChannel) * 128 + (bytes[1] & 0x7f);
+        const bool isNoteOn = status == 0x90 && bytes[2] > 0;
+        const bool isNoteOff = status == 0x80 || (status == 0x90 && bytes[2] == 0);
+
+        if (isNoteOn) {
+            const uint8_t outNote = _tables->note[bytes[1] & 0x7f];
+            _heldNote[slot] = uint8_t(outNote | 0x80);
+            _heldChannel[slot] = outChannel;
+            bytes[1] = outNote;
+            bytes[2] = _tables->velocity[bytes[2] & 0x7f];
+        } else if (_heldNote[slot] != 0) {
+            // Note-offs and poly aftertouch follow their note-on
+            outChannel = _heldChannel[slot];
+            bytes[1] = uint8_t(_heldNote[slot] & 0x7f);
+            if (isNoteOff)
+                _heldNote[slot] = 0;
+        } else {
+            bytes[1] = _tables->note[bytes[1] & 0x7f];
+        }
+    }
+
+    bytes[0] = uint8_t(status | outChannel);
+}
+
+} // namespace midisender
@@ -0,0 +1,97 @@
+//
+//  MidiTransform.h
+//  MidiSender
+//
+//  Transpose, key-range clamp, velocity curve and channel remap, applied to
+//  raw MIDI bytes before they are forwarded or encoded. Settings are compiled
+//  off the audio thread into 128-entry lookup tables, so transforming an
+//  event costs a couple of array loads.
+//
+
+#pragma once
+
+#include "RealtimeExchange.h"
+
+#include <array>
+#include <cstdint>
+
+namespace midisender
+{
+
+enum class VelocityCurve : uint8_t {
+    linear,
+    soft,    // lifts quiet notes
+    hard,    // needs more force for the same output
+    fixed    // every note at full velocity
+};
+
+namespace curves
+{
+constexpr std::array<uint8_t, 128> make(VelocityCurve curve) {
+    std::array<uint8_t, 128> table {};
+    for (int v = 0; v < 128; ++v) {
+        int out = v;
+        switch (curve) {
+            case VelocityCurve::linear: out = v; break;
+            case VelocityCurve::soft:   out = 127 - ((127 - v) * (127 - v) + 63) / 127; break;
+            case VelocityCurve::hard:   out = (v * v + 63) / 127; break;
+            case VelocityCurve::fixed:  out = 127; break;
+        }
+        // Never turn a note-on into a note-off
+        table[(size_t) v] = uint8_t(v > 0 && out == 0 ? 1 : out);
+    }
+    table[0] = 0;
+    return table;
+}
+
+constexpr auto linear = make(VelocityCurve::linear);
+constexpr auto soft = make(VelocityCurve::soft);
+constexpr auto hard = make(VelocityCurve::hard);
+constexpr auto fixed = make(VelocityCurve::fixed);
+
+static_assert(soft[64] > 64 && hard[64] < 64, "curve shapes");
+}
+
+struct MidiTransformSettings {
+    int transpose = 0;                       // semitones
+    int lowKey = 0;                          // notes outside [lowKey, highKey] are moved
+    int highKey = 127;                       // by octaves into the range, then clamped
+    VelocityCurve velocityCurve = VelocityCurve::linear;
+    int outputChannel = 0;                   // 1..16, 0 = keep
+};
+
+struct MidiTransformTables {
+    std::array<uint8_t, 128> note {};
+    std::array<uint8_t, 128> velocity {};
+    std::array<uint8_t, 16> channel {};      // 0-based in, 0-based out
+
+    static MidiTransformTables compile(const MidiTransformSettings& settings);
+};
+
+/** Audio-thread side. Remembers where each note-on went so that the matching
+    note-off follows it even if the tables change while the note is held. */
+class MidiTransformStage {
+public:
+    MidiTransformStage();
+
+    /** Message thread. */
+    void setSettings(const MidiTransformSettings& settings);
+
+    /** Audio thread, once per block. */
+    void beginBlock() { _tables = _exchange.acquire(); }
+
+    /** Audio thread. Rewrites a channel voice message in place; other
+        messages are left alone. */
+    void process(uint8_t* bytes, int numBytes);
+
+    /** Audio thread. Forgets held-note mappings. */
+    void reset();
+
+private:
+    RealtimeExchange<MidiTransformTables> _exchange;
+    const MidiTransformTables* _tables = nullptr;
+    std::array<uint8_t, 16 * 128> _heldNote {};      // output note | 0x80, 0 = not held
+    std::array<uint8_t, 16 * 128> _heldChannel {};
+};
+
+} // namespace midisender
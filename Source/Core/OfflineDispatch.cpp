@@ -0,0 +1,120 @@
+//
+//  OfflineDispatch.cpp
+//  MidiSender
+//
+
+#include "OfflineDispatch.h"
+#include "OscPacket.h"
+
+#include <cctype>
+#include <cerrno>
+#include <ctime>
+
+namespace midisender
+{
+
+bool OfflinePacer::schedule(const MidiEvent& event, Clock::time_point now, const uint8_t* sysEx) {
+    if (! _isAnchored || event.time < _lastSongTime) {
+        _isAnchored = true;
+        _anchorSongTime = event.time;
+        _anchorWallTime = now;
+    }
+    _lastSongTime = event.time;
+
+    if (_pending.size() >= _maxPending)
+        return false;
+    _pending.push_back({ event, {} });
+    if (sysEx != nullptr)
+        _pending.back().sysEx.assign(sysEx, sysEx + event.sysExSize);
+    return true;
+}
+
+void OfflinePacer::clear() {
+    _pending.clear();
+    _isAnchored = false;
+}
+
+OfflinePacer::Clock::time_point OfflinePacer::dueTime(const MidiEvent& event) const {
+    const std::chrono::duration<double> offset(event.time - _anchorSongTime);
+    return _anchorWallTime + std::chrono::duration_cast<Clock::duration>(offset);
+}
+
+//==============================================================================
+bool OscFileLog::open(const std::string& folder, const std::string& name) {
+    close();
+
+    const auto now = std::time(nullptr);
+    std::tm local {};
+    localtime_r(&now, &local);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+
+    // The main ID is user text: keep it to one plain file name.
+    std::string safeName = name.empty() ? "MidiSender" : name;
+    for (auto& c : safeName)
+        if (! std::isalnum((unsigned char) c) && c != '-' && c != '_' && c != '.')
+            c = '_';
+    if (safeName.front() == '.')
+        safeName.front() = '_';
+
+    auto base = folder;
+    if (! base.empty() && base.back() != '/')
+        base += '/';
+    base += safeName + "-" + stamp;
+
+    // Renders that start within the same second get -2, -3, ... rather than
+    // overwriting each other.
+    for (int attempt = 1; attempt <= 1000; ++attempt) {
+        _path = base + (attempt > 1 ? "-" + std::to_string(attempt) : std::string()) + ".osclog";
+        _file = std::fopen(_path.c_str(), "wx");
+        if (_file != nullptr || errno != EEXIST)
+            break;
+    }
+    return _file != nullptr;
+}
+
+void OscFileLog::close() {
+    if (_file != nullptr) {
+        std::fclose(_file);
+        _file = nullptr;
+    }
+}
+
+bool OscFileLog::write(double songTime, const uint8_t* packet, size_t size) {
+    if (_file == nullptr)
+        return false;
+
+    return OscPacketReader::parse(packet, size, [this, songTime](const OscMessageView& message, uint64_t) {
+        std::fprintf(_file, "%.6f %.*s %.*s", songTime,
+                     (int) message.address.size(), message.address.data(),
+                     (int) message.typeTags.size(), message.typeTags.data());
+
+        for (size_t i = 0; i < message.numArguments(); ++i) {
+            int32_t intValue;
+            float floatValue;
+            std::string_view stringValue;
+            const uint8_t* blob;
+            size_t blobSize;
+
+            if (message.getInt32(i, intValue))
+                std::fprintf(_file, " %d", intValue);
+            else if (message.getFloat32(i, floatValue))
+                std::fprintf(_file, " %g", floatValue);
+            else if (message.getString(i, stringValue))
+                std::fprintf(_file, " \"%.*s\"", (int) stringValue.size(), stringValue.data());
+            else if (message.getBlob(i, blob, blobSize)) {
+                std::fputc(' ', _file);
+                for (size_t b = 0; b < blobSize; ++b)
+                    std::fprintf(_file, "%02x", blob[b]);
+            }
+        }
+        std::fputc('\n', _file);
+    });
+}
+
+void OscFileLog::flush() {
+    if (_file != nullptr)
+        std::fflush(_file);
+}
+
+} // namespace midisender
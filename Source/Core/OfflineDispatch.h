@@ -0,0 +1,114 @@
+//
+//  OfflineDispatch.h
+//  MidiSender
+//
+//  What the sender thread does with events rendered faster than realtime
+//  (bounce, freeze). Both helpers live on the sender thread only, so the
+//  render itself never waits for the network or the disk.
+//
+
+#pragma once
+
+#include "MidiEvent.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace midisender
+{
+
+enum class OfflineMode : uint8_t {
+    sendImmediately,   // default: blast everything out as it is rendered
+    suppress,          // send nothing while rendering offline
+    paceToWallClock,   // hold events back and send them at their song-position time
+    writeToFile        // log the OSC packets with their song time to a file
+};
+
+/** Buffers offline events and releases them at the pace of the song position.
+    The first event of a render anchors song time to the wall clock; a jump
+    backwards in song time starts a new anchor. SysEx payloads are copied, so
+    the caller can free its own copy as soon as the event is scheduled. */
+class OfflinePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit OfflinePacer(size_t maxPending = size_t(1) << 20) : _maxPending(maxPending) {}
+
+    /** Returns false (and drops the event) once maxPending events are waiting.
+        sysEx points at the event's sysExSize bytes for SysEx, else nullptr. */
+    bool schedule(const MidiEvent& event, Clock::time_point now, const uint8_t* sysEx = nullptr);
+
+    /** Calls send(event, dueTime, sysEx) for every event whose time has come;
+        sysEx is the copied payload, or nullptr for other events. */
+    template <typename SendFunction>
+    void releaseDue(Clock::time_point now, SendFunction&& send) {
+        while (! _pending.empty()) {
+            const auto& pending = _pending.front();
+            const auto due = dueTime(pending.event);
+            if (due > now)
+                break;
+            send(pending.event, due, pending.sysEx.empty() ? nullptr : pending.sysEx.data());
+            _pending.pop_front();
+        }
+    }
+
+    /** Calls send(event, dueTime, sysEx) for every waiting event, due or not,
+        and drops the anchor. Used once the render is over. */
+    template <typename SendFunction>
+    void releaseAll(SendFunction&& send) {
+        for (const auto& pending : _pending)
+            send(pending.event, dueTime(pending.event), pending.sysEx.empty() ? nullptr : pending.sysEx.data());
+        clear();
+    }
+
+    void clear();
+    size_t getNumPending() const { return _pending.size(); }
+
+private:
+    Clock::time_point dueTime(const MidiEvent& event) const;
+
+    struct Pending {
+        MidiEvent event;
+        std::vector<uint8_t> sysEx;
+    };
+
+    std::deque<Pending> _pending;
+    size_t _maxPending;
+    bool _isAnchored = false;
+    double _anchorSongTime = 0.0;
+    double _lastSongTime = 0.0;
+    Clock::time_point _anchorWallTime;
+};
+
+/** Text log of offline OSC output, one line per message:
+        <song time in seconds> <address> <type tags> <arguments...> */
+class OscFileLog {
+public:
+    OscFileLog() = default;
+    ~OscFileLog() { close(); }
+
+    OscFileLog(const OscFileLog&) = delete;
+    OscFileLog& operator=(const OscFileLog&) = delete;
+
+    /** Creates <folder>/<name>-<YYYYMMDD-HHMMSS>.osclog, adding -2, -3, ...
+        before the extension if that file exists. Characters of name other
+        than letters, digits, '-', '_' and '.' become '_'. */
+    bool open(const std::string& folder, const std::string& name);
+    void close();
+    bool isOpen() const { return _file != nullptr; }
+    const std::string& getPath() const { return _path; }
+
+    /** Writes every message of an encoded packet. */
+    bool write(double songTime, const uint8_t* packet, size_t size);
+    void flush();
+
+private:
+    std::FILE* _file = nullptr;
+    std::string _path;
+};
+
+} // namespace midisender
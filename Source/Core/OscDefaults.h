@@ -0,0 +1,26 @@
+//
+//  OscDefaults.h
+//  MidiSender
+//
+
+#pragma once
+
+#define DEFAULT_OSC_HOST "127.0.0.1"
+#define DEFAULT_OSC_PORT 9001
+#define DEFAULT_OSC_MAIN_ID "trackId"
+#define MIN_OSC_PORT 1
+#define MAX_OSC_PORT 65535
+#define DEFAULT_MULTICAST_GROUP "239.255.0.1"
+#define DEFAULT_MULTICAST_TTL 1
+#define MAX_MULTICAST_TTL 255
+#define DEFAULT_SYNC_PORT 0
+#define DEFAULT_SNAPSHOT_INTERVAL_MS 1000
+#define MAX_SNAPSHOT_INTERVAL_MS 60000
+#define DEFAULT_OFFLINE_MODE midisender::OfflineMode::sendImmediately
+#define NUM_MACRO_PARAMETERS 8
+#define DEFAULT_PARAM_RATE_HZ 60
+#define MAX_PARAM_RATE_HZ 1000
+#define DEFAULT_PARAM_SMOOTHING_MS 0
+#define MAX_PARAM_SMOOTHING_MS 2000
+#define DEFAULT_CLOCK_SYNC_INTERVAL_MS 0
+#define MAX_CLOCK_SYNC_INTERVAL_MS 10000
@@ -0,0 +1,633 @@
+//
+//  OscEngine.cpp
+//  MidiSender
+//
+
+#include "OscEngine.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace midisender
+{
+
+namespace
+{
+// How often the sender thread polls the queue. Polling keeps the audio thread
+// free of any wake-up syscall at the cost of up to this much added latency.
+constexpr auto dispatchInterval = std::chrono::milliseconds(1);
+}
+
+OscEngine::OscEngine(size_t queueCapacity, size_t sysExPoolSize)
+    : _queue(queueCapacity),
+      _sysExPool(sysExPoolSize),
+      _host(DEFAULT_OSC_HOST),
+      _port(DEFAULT_OSC_PORT),
+      _snapshotWriter(4096),
+      _receiveBuffer(1536),
+      _lastSnapshotTime(std::chrono::steady_clock::now()) {
+    _offlineParameterValues.fill(std::numeric_limits<float>::quiet_NaN());
+    _thread = std::thread([this] { run(); });
+}
+
+OscEngine::~OscEngine() {
+    _running = false;
+    if (_thread.joinable())
+        _thread.join();
+}
+
+void OscEngine::setMainId(const std::string& mainId) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _encoder.setMainId(mainId);
+}
+
+void OscEngine::setRoutingRules(const std::vector<RoutingRule>& rules) {
+    auto table = std::make_unique<RoutingTable>();
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        RouteSet set;
+        set.generation = _nextRoutingGeneration++;
+        set.rules = rules;
+        set.table.compile(rules, set.generation);
+        buildRoutes(set);
+        *table = set.table;
+
+        // Events still queued or paced name routes of the previous sets.
+        _routeSets.push_back(std::move(set));
+        if (_routeSets.size() > maxRouteSets)
+            _routeSets.pop_front();
+    }
+    _routingExchange.publish(std::move(table));
+}
+
+void OscEngine::buildRoutes(RouteSet& set) {
+    auto& routes = set.routes;
+    routes.clear();
+    routes.resize(std::min(set.rules.size(), RoutingTable::maxRules));
+
+    for (size_t i = 0; i < routes.size(); ++i) {
+        const auto& rule = set.rules[i];
+        auto& route = routes[i];
+
+        if (! rule.mainId.empty()) {
+            route.encoder = std::make_unique<MidiOscEncoder>();
+            route.encoder->setMainId(rule.mainId);
+            route.encoder->setParameterNames(_parameterNames);
+        }
+
+        if (! rule.usesDefaultDestination()) {
+            const auto& host = rule.host.empty() ? _host : rule.host;
+            const int port = rule.port == 0 ? _port : rule.port;
+            const bool multicast = _multicastEnabled && isMulticastAddress(host);
+            route.sender = std::make_unique<UdpSender>();
+            route.sender->connect(host, port, multicast ? &_multicastOptions : nullptr);
+            // Pongs from a group would come from every member at once.
+            if (! isMulticastAddress(host))
+                route.clock = std::make_unique<ClockEstimator>();
+        }
+
+        // Rules that only split a range of the same receiver share its snapshot.
+        const auto sameDestination = [&](const RoutingRule& other) {
+            return (other.host.empty() ? _host : other.host) == (rule.host.empty() ? _host : rule.host)
+                && (other.port == 0 ? _port : other.port) == (rule.port == 0 ? _port : rule.port)
+                && (other.mainId.empty() ? _encoder.getMainId() : other.mainId) == (rule.mainId.empty() ? _encoder.getMainId() : rule.mainId);
+        };
+        route.destination = i + 1;
+        if (sameDestination(RoutingRule()))
+            route.destination = 0;
+        else
+            for (size_t j = 0; j < i; ++j)
+                if (sameDestination(set.rules[j])) {
+                    route.destination = routes[j].destination;
+                    break;
+                }
+    }
+}
+
+void OscEngine::setHost(const std::string& host) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _host = host;
+    }
+    connect();
+}
+
+void OscEngine::setPort(int port) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _port = port;
+    }
+    connect();
+}
+
+void OscEngine::setDestination(const std::string& host, int port) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _host = host;
+        _port = port;
+    }
+    connect();
+}
+
+void OscEngine::setMulticast(bool enabled, const MulticastOptions& options) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _multicastEnabled = enabled;
+        _multicastOptions = options;
+    }
+    connect();
+}
+
+bool OscEngine::connect() {
+    std::lock_guard<std::mutex> guard(_lock);
+    _isConnected = false;
+    _sender.disconnect();
+    _isConnected = _sender.connect(_host, _port, _multicastEnabled ? &_multicastOptions : nullptr);
+    _clock.reset();
+    _isDefaultUnicast = ! _multicastEnabled && ! isMulticastAddress(_host);
+    for (auto& set : _routeSets)
+        buildRoutes(set);
+    return _isConnected;
+}
+
+bool OscEngine::sendValue(float value, std::string_view name) {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (! _isConnected || ! _encoder.encodeValue(name, value, _writer))
+        return false;
+    sendPacket();
+    return true;
+}
+
+void OscEngine::setStreamedParameters(const std::vector<StreamedParameter>& parameters) {
+    std::vector<std::string> names;
+    for (const auto& parameter : parameters)
+        names.push_back(parameter.name);
+
+    std::lock_guard<std::mutex> guard(_lock);
+    _parameterStream.setParameters(parameters);
+    _parameterNames = names;
+    _encoder.setParameterNames(names);
+    for (auto& set : _routeSets)
+        for (auto& route : set.routes)
+            if (route.encoder != nullptr)
+                route.encoder->setParameterNames(names);
+}
+
+void OscEngine::streamParameters(std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _parameterStream.update(now, [this](int index, float value) {
+        forEachDestination([&](size_t, const MidiOscEncoder& encoder, UdpSender& sender, const ClockEstimator*) {
+            if (sender.isConnected() && encoder.encodeParameter((size_t) index, value, _writer))
+                sendPacket(sender, _writer);
+        });
+    });
+}
+
+bool OscEngine::getClockEstimate(size_t destination, double& offsetSeconds, double& drift) {
+    std::lock_guard<std::mutex> guard(_lock);
+    const auto* routes = _routeSets.empty() ? nullptr : &_routeSets.back().routes;
+    const ClockEstimator* clock = destination == 0 ? defaultClock()
+                                : routes != nullptr && destination <= routes->size() ? (*routes)[destination - 1].clock.get()
+                                : nullptr;
+    if (clock == nullptr || ! clock->hasEstimate())
+        return false;
+
+    offsetSeconds = clock->getOffset(oscTimeTagFromSystemTime(std::chrono::system_clock::now()));
+    drift = clock->getDrift();
+    return true;
+}
+
+void OscEngine::setOfflineLogFolder(const std::string& folder) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _offlineLogFolder = folder;
+    _fileLog.close();
+}
+
+void OscEngine::resetNoteState() {
+    std::lock_guard<std::mutex> guard(_lock);
+    _noteState.reset();
+}
+
+size_t OscEngine::getNumPacedPending() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _pacer.getNumPending();
+}
+
+std::string OscEngine::getOfflineLogPath() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _fileLog.getPath();
+}
+
+bool OscEngine::pushEvent(const MidiEvent& event) {
+    if (_block.isNonRealtime && _offlineMode.load(std::memory_order_relaxed) == OfflineMode::suppress)
+        return true;
+
+    auto routed = event;
+    if (_routingTable != nullptr) {
+        routed.route = _routingTable->lookup(event);
+        routed.routing = _routingTable->getGeneration();
+    }
+    routed.isOffline = _block.isNonRealtime;
+    routed.startsRender = routed.isOffline && _isNewRender;
+    routed.time = _block.timeInSeconds + event.samplePosition / _block.sampleRate;
+
+    if (_queue.push(routed)) {
+        if (routed.startsRender)
+            _isNewRender = false;
+        return true;
+    }
+    _numDropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool OscEngine::pushSysEx(const uint8_t* data, int size, int samplePosition) {
+    if (_block.isNonRealtime && _offlineMode.load(std::memory_order_relaxed) == OfflineMode::suppress)
+        return true;
+
+    MidiEvent event;
+    event.type = MidiEvent::Type::sysEx;
+    event.samplePosition = samplePosition;
+    event.sysExSize = (uint32_t) std::max(size, 0);
+    if (_routingTable != nullptr) {
+        event.route = _routingTable->lookup(event);
+        event.routing = _routingTable->getGeneration();
+    }
+    event.isOffline = _block.isNonRealtime;
+    event.startsRender = event.isOffline && _isNewRender;
+    event.time = _block.timeInSeconds + samplePosition / _block.sampleRate;
+
+    if (_sysExPool.write(data, event.sysExSize, event.sysExPosition)) {
+        if (_queue.push(event)) {
+            if (event.startsRender)
+                _isNewRender = false;
+            return true;
+        }
+        _sysExPool.discard(event.sysExPosition);
+    }
+    _numDropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void OscEngine::pushOfflineParameter(int index, float value) {
+    if (index < 0 || index >= ParameterStream::maxParameters
+        || _offlineMode.load(std::memory_order_relaxed) == OfflineMode::suppress)
+        return;
+
+    auto& last = _offlineParameterValues[(size_t) index];
+    if (last == value)
+        return;
+    last = value;
+
+    MidiEvent event;
+    event.type = MidiEvent::Type::parameter;
+    event.data1 = (uint8_t) index;
+    event.value = value;
+    event.isOffline = true;
+    event.startsRender = _isNewRender;
+    event.time = _block.timeInSeconds;
+    if (_queue.push(event))
+        _isNewRender = false;
+    else
+        _numDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OscEngine::dispatchPending() {
+    std::lock_guard<std::mutex> guard(_lock);
+    MidiEvent event;
+    bool wroteToFile = false;
+    while (_queue.pop(event)) {
+        if (! event.isOffline) {
+            finishOfflineRender();
+            dispatch(event, oscTimeTagImmediately);
+        } else {
+            // Realtime blocks without MIDI leave no trace in the queue, so the
+            // previous render may still be open.
+            if (event.startsRender)
+                finishOfflineRender();
+            wroteToFile |= _offlineMode.load() == OfflineMode::writeToFile;
+            dispatchOffline(event);
+        }
+
+        if (event.isSysEx())
+            _sysExPool.release(event.sysExPosition, event.sysExSize);
+    }
+
+    if (_pacer.getNumPending() > 0) {
+        _pacer.releaseDue(OfflinePacer::Clock::now(), [this](const MidiEvent& due, OfflinePacer::Clock::time_point dueTime, const uint8_t* sysEx) {
+            dispatch(due, pacedTimeTag(dueTime), sysEx);
+        });
+    }
+
+    if (wroteToFile)
+        _fileLog.flush();
+}
+
+void OscEngine::finishOfflineRender() {
+    // Back to realtime: the render is over. Whatever it still holds goes out
+    // now, stamped with its due time, and its log is completed.
+    _pacer.releaseAll([this](const MidiEvent& due, OfflinePacer::Clock::time_point dueTime, const uint8_t* sysEx) {
+        dispatch(due, pacedTimeTag(dueTime), sysEx);
+    });
+
+    if (_fileLog.isOpen()) {
+        _fileLog.flush();
+        _fileLog.close();
+    }
+}
+
+uint64_t OscEngine::pacedTimeTag(OfflinePacer::Clock::time_point dueTime) const {
+    const auto fromNow = dueTime - OfflinePacer::Clock::now();
+    return oscTimeTagFromSystemTime(std::chrono::system_clock::now()
+                                    + std::chrono::duration_cast<std::chrono::system_clock::duration>(fromNow));
+}
+
+const OscEngine::Route* OscEngine::findRoute(const MidiEvent& event) {
+    if (event.route == RoutingTable::defaultRoute)
+        return nullptr;
+
+    for (size_t i = _routeSets.size(); i-- > 0;) {
+        if (_routeSets[i].generation != event.routing)
+            continue;
+        // Events are dispatched in the order they were routed, so no later
+        // event can name one of the older sets.
+        _routeSets.erase(_routeSets.begin(), _routeSets.begin() + (std::ptrdiff_t) i);
+        const auto& routes = _routeSets.front().routes;
+        return event.route <= routes.size() ? &routes[event.route - 1] : nullptr;
+    }
+    return nullptr;   // routed by a set that has been dropped, see maxRouteSets
+}
+
+template <typename Function>
+void OscEngine::forEachDestination(Function&& function) {
+    function(size_t(0), static_cast<const MidiOscEncoder&>(_encoder), _sender, defaultClock());
+    if (_routeSets.empty())
+        return;
+
+    auto& routes = _routeSets.back().routes;
+    for (size_t i = 0; i < routes.size(); ++i) {
+        auto& route = routes[i];
+        if (route.destination == i + 1)
+            function(i + 1, static_cast<const MidiOscEncoder&>(route.encoder != nullptr ? *route.encoder : _encoder),
+                     route.sender != nullptr ? *route.sender : _sender,
+                     route.sender != nullptr ? static_cast<const ClockEstimator*>(route.clock.get()) : defaultClock());
+    }
+}
+
+void OscEngine::dispatch(const MidiEvent& event, uint64_t timeTag, const uint8_t* sysEx) {
+    if (event.isSysEx()) {
+        // Paced SysEx brings its own copy, the pool slot is long released by then.
+        dispatchSysEx(event, sysEx != nullptr ? sysEx : _sysExPool.getData(event.sysExPosition));
+        return;
+    }
+    if (event.isParameter()) {
+        dispatchParameter(event, timeTag);
+        return;
+    }
+
+    _noteState.apply(event);
+
+    const Route* route = findRoute(event);
+    const auto& encoder = route != nullptr && route->encoder != nullptr ? *route->encoder : _encoder;
+    auto& sender = route != nullptr && route->sender != nullptr ? *route->sender : _sender;
+    const auto* clock = route != nullptr && route->sender != nullptr ? route->clock.get() : defaultClock();
+
+    // Absolute times are converted to the destination's clock once it has answered a ping.
+    if (timeTag != oscTimeTagImmediately && clock != nullptr && clock->hasEstimate())
+        timeTag = clock->toRemote(timeTag);
+
+    if (sender.isConnected() && encoder.encodeNote(event, _writer, timeTag))
+        sendPacket(sender, _writer);
+}
+
+void OscEngine::dispatchOffline(const MidiEvent& event) {
+    switch (_offlineMode.load()) {
+        case OfflineMode::sendImmediately:
+            dispatch(event, oscTimeTagImmediately);
+            break;
+
+        case OfflineMode::suppress:
+            break;
+
+        case OfflineMode::paceToWallClock:
+            // The pacer copies SysEx, its pool slot is released right after this.
+            if (! _pacer.schedule(event, OfflinePacer::Clock::now(),
+                                  event.isSysEx() ? _sysExPool.getData(event.sysExPosition) : nullptr))
+                _numDropped.fetch_add(1, std::memory_order_relaxed);
+            break;
+
+        case OfflineMode::writeToFile: {
+            const Route* route = findRoute(event);
+            const auto& encoder = route != nullptr && route->encoder != nullptr ? *route->encoder : _encoder;
+
+            // Song time jumping backwards means a new render: start a new file.
+            if (event.time < _lastLoggedTime)
+                _fileLog.close();
+            _lastLoggedTime = event.time;
+
+            if (! _fileLog.isOpen() && ! _fileLog.open(_offlineLogFolder, _encoder.getMainId()))
+                break;
+            if (event.isSysEx())
+                logSysEx(event, encoder);
+            else if (event.isParameter() && _encoder.encodeParameter(event.data1, event.value, _writer))
+                _fileLog.write(event.time, _writer.data(), _writer.size());
+            else if (encoder.encodeNote(event, _writer))
+                _fileLog.write(event.time, _writer.data(), _writer.size());
+            break;
+        }
+    }
+}
+
+void OscEngine::dispatchSysEx(const MidiEvent& event, const uint8_t* data) {
+    const Route* route = findRoute(event);
+    const auto& encoder = route != nullptr && route->encoder != nullptr ? *route->encoder : _encoder;
+    auto& sender = route != nullptr && route->sender != nullptr ? *route->sender : _sender;
+
+    const auto capacity = encoder.getSysExFragmentCapacity();
+    if (! sender.isConnected() || capacity == 0)
+        return;
+
+    // Each datagram is the encoded header followed by the message bytes where they sit.
+    static const uint8_t padding[4] = {};
+    const int count = int((event.sysExSize + capacity - 1) / capacity);
+    const auto messageId = _nextSysExId++;
+    for (int i = 0; i < count; ++i) {
+        const size_t offset = (size_t) i * capacity;
+        const size_t size = std::min<size_t>(capacity, event.sysExSize - offset);
+        if (! encoder.encodeSysExHeader(messageId, i, count, size, _writer))
+            return;
+
+        const UdpSender::ByteRange parts[] = {
+            { _writer.data(), _writer.size() },
+            { data + offset, size },
+            { padding, MidiOscEncoder::getBlobPadding(size) }
+        };
+        if (sender.send(parts, 3))
+            _numSent.fetch_add(1, std::memory_order_relaxed);
+        else
+            _numSendFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void OscEngine::dispatchParameter(const MidiEvent& event, uint64_t timeTag) {
+    forEachDestination([&](size_t, const MidiOscEncoder& encoder, UdpSender& sender, const ClockEstimator* clock) {
+        const bool convert = timeTag != oscTimeTagImmediately && clock != nullptr && clock->hasEstimate();
+        const auto remoteTimeTag = convert ? clock->toRemote(timeTag) : timeTag;
+        if (sender.isConnected() && encoder.encodeParameter(event.data1, event.value, _writer, remoteTimeTag))
+            sendPacket(sender, _writer);
+    });
+}
+
+void OscEngine::logSysEx(const MidiEvent& event, const MidiOscEncoder& encoder) {
+    const auto* data = _sysExPool.getData(event.sysExPosition);
+    const auto capacity = encoder.getSysExFragmentCapacity();
+    if (capacity == 0)
+        return;
+
+    const int count = int((event.sysExSize + capacity - 1) / capacity);
+    const auto messageId = _nextSysExId++;
+    for (int i = 0; i < count; ++i) {
+        const size_t offset = (size_t) i * capacity;
+        const size_t size = std::min<size_t>(capacity, event.sysExSize - offset);
+        if (encoder.encodeSysExFragment(messageId, i, count, data + offset, size, _writer))
+            _fileLog.write(event.time, _writer.data(), _writer.size());
+    }
+}
+
+bool OscEngine::sendSnapshot() {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (! _isConnected)
+        return false;
+
+    _noteState.read(_snapshot);
+    const RoutingTable* table = _routeSets.empty() ? nullptr : &_routeSets.back().table;
+    const auto* routes = table != nullptr ? &_routeSets.back().routes : nullptr;
+
+    bool sent = true;
+    forEachDestination([&](size_t destination, const MidiOscEncoder& encoder, UdpSender& sender, const ClockEstimator*) {
+        if (! sender.isConnected())
+            return;
+
+        // Keep only the held notes the current rules send to this destination.
+        _routedSnapshot = _snapshot;
+        if (table != nullptr) {
+            for (int channel = 0; channel < ActiveNoteState::numChannels; ++channel) {
+                for (int note = 0; note < ActiveNoteState::numNotes; ++note) {
+                    if (! _snapshot.isActive(channel, note))
+                        continue;
+                    const auto route = table->lookupNote(channel + 1, note);
+                    const auto target = route == RoutingTable::defaultRoute ? 0 : (*routes)[route - 1].destination;
+                    if (target != destination) {
+                        const int slot = channel * ActiveNoteState::numNotes + note;
+                        _routedSnapshot.bits[(size_t) slot / 64] &= ~(uint64_t(1) << (slot % 64));
+                    }
+                }
+            }
+        }
+
+        if (encoder.encodeNoteState(_routedSnapshot, _snapshotWriter))
+            sendPacket(sender, _snapshotWriter);
+        else
+            sent = false;
+    });
+    return sent;
+}
+
+void OscEngine::pollSyncRequests(int timeoutMs) {
+    const int size = _syncReceiver.receive(_receiveBuffer.data(), _receiveBuffer.size(), timeoutMs);
+    if (size <= 0)
+        return;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    OscPacketReader::parse(_receiveBuffer.data(), (size_t) size, [this](const OscMessageView& message, uint64_t) {
+        if (_encoder.isSyncRequest(message.address))
+            _snapshotRequested = true;
+    });
+}
+
+void OscEngine::updateSyncSocket() {
+    const int port = _syncPort.load();
+    if (port == _appliedSyncPort)
+        return;
+
+    _appliedSyncPort = port;
+    _syncReceiver.close();
+    _boundSyncPort = (port > 0 && _syncReceiver.bind(port)) ? port : 0;
+}
+
+void OscEngine::syncClocks() {
+    // Nothing else carries a timetag the estimate could correct.
+    const int interval = _clockSyncIntervalMs.load();
+    if (interval <= 0 || _offlineMode.load() != OfflineMode::paceToWallClock)
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    const bool sendPing = now - _lastClockPing >= std::chrono::milliseconds(interval);
+    if (sendPing)
+        _lastClockPing = now;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    // Answers to a multicast ping would come from every group member at once.
+    if (defaultClock() != nullptr)
+        syncClock(_sender, _encoder, _clock, sendPing);
+
+    if (_routeSets.empty())
+        return;
+    for (auto& route : _routeSets.back().routes)
+        if (route.sender != nullptr && route.clock != nullptr)   // no clock for multicast groups
+            syncClock(*route.sender, route.encoder != nullptr ? *route.encoder : _encoder, *route.clock, sendPing);
+}
+
+void OscEngine::syncClock(UdpSender& sender, const MidiOscEncoder& encoder, ClockEstimator& clock, bool sendPing) {
+    if (! sender.isConnected())
+        return;
+
+    int size;
+    while ((size = sender.receive(_receiveBuffer.data(), _receiveBuffer.size(), 0)) > 0) {
+        const auto arrivalTime = oscTimeTagFromSystemTime(std::chrono::system_clock::now());
+        OscPacketReader::parse(_receiveBuffer.data(), (size_t) size, [&](const OscMessageView& message, uint64_t) {
+            uint64_t t1, t2, t3;
+            if (encoder.isClockPong(message.address)
+                && message.getTimeTag(0, t1) && message.getTimeTag(1, t2) && message.getTimeTag(2, t3))
+                clock.addSample(t1, t2, t3, arrivalTime);
+        });
+    }
+
+    if (sendPing && encoder.encodeClockPing(oscTimeTagFromSystemTime(std::chrono::system_clock::now()), _writer))
+        sendPacket(sender, _writer);
+}
+
+void OscEngine::sendPacket() {
+    sendPacket(_sender, _writer);
+}
+
+void OscEngine::sendPacket(UdpSender& sender, const OscPacketWriter& writer) {
+    if (sender.send(writer.data(), writer.size()))
+        _numSent.fetch_add(1, std::memory_order_relaxed);
+    else
+        _numSendFailures.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OscEngine::run() {
+    while (_running) {
+        dispatchPending();
+        streamParameters();
+        syncClocks();
+
+        const int interval = _snapshotIntervalMs.load();
+        const auto sinceLastSnapshot = std::chrono::steady_clock::now() - _lastSnapshotTime;
+        if (_snapshotRequested.exchange(false)
+            || (interval > 0 && sinceLastSnapshot >= std::chrono::milliseconds(interval))) {
+            sendSnapshot();
+            _lastSnapshotTime = std::chrono::steady_clock::now();
+        }
+
+        // Waiting on the sync socket doubles as the dispatch sleep.
+        updateSyncSocket();
+        if (_appliedSyncPort > 0)
+            pollSyncRequests((int) dispatchInterval.count());
+        else
+            std::this_thread::sleep_for(dispatchInterval);
+    }
+}
+
+} // namespace midisender
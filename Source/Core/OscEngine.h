@@ -0,0 +1,272 @@
+//
+//  OscEngine.h
+//  MidiSender
+//
+//  Realtime core of the sender. The audio thread only pushes MidiEvents into
+//  a lock-free queue; a background thread encodes them as OSC and sends them.
+//  Configuration calls come from the message thread and never touch the
+//  audio thread's data.
+//
+
+#pragma once
+
+#include "ActiveNoteState.h"
+#include "ClockSync.h"
+#include "MidiEvent.h"
+#include "MidiOscEncoder.h"
+#include "OfflineDispatch.h"
+#include "OscDefaults.h"
+#include "OscPacket.h"
+#include "ParameterStream.h"
+#include "RoutingTable.h"
+#include "SpscQueue.h"
+#include "SysExPool.h"
+#include "UdpTransport.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace midisender
+{
+
+/** Per-block host state handed to OscEngine::beginBlock(). */
+struct BlockContext {
+    bool isNonRealtime = false;
+    double timeInSeconds = 0.0;   // song position at the first sample
+    double sampleRate = 44100.0;
+};
+
+class OscEngine {
+public:
+    explicit OscEngine(size_t queueCapacity = 4096, size_t sysExPoolSize = 64 * 1024);
+    ~OscEngine();
+
+    OscEngine(const OscEngine&) = delete;
+    OscEngine& operator=(const OscEngine&) = delete;
+
+    //==============================================================================
+    // Message thread
+    void setMainId(const std::string& mainId);
+    void setHost(const std::string& host);
+    void setPort(int port);
+    void setDestination(const std::string& host, int port);
+
+    /** Switches between unicast and multicast group mode. In multicast mode the
+        host must be a group address (e.g. 239.x.x.x) and one send reaches every
+        subscribed receiver. */
+    void setMulticast(bool enabled, const MulticastOptions& options);
+    bool isMulticast() const { return _multicastEnabled.load(); }
+
+    bool connect();
+    bool isConnected() const { return _isConnected.load(); }
+
+    /** Sends /<mainId>/<name> immediately from the calling (non-audio) thread. */
+    bool sendValue(float value, std::string_view name);
+
+    /** Declares the parameters streamed as /<mainId>/param/<name> to every
+        destination, in the order used by setParameterValue(). */
+    void setStreamedParameters(const std::vector<StreamedParameter>& parameters);
+
+    /** Local UDP port on which /<mainId>/sync queries are accepted, 0 = off.
+        The sender thread (re)binds it on its next tick. */
+    void setSyncPort(int port) { _syncPort = port; }
+
+    /** Period of the /<mainId>/noteState snapshots, 0 = only on request. */
+    void setSnapshotInterval(int milliseconds) { _snapshotIntervalMs = milliseconds; }
+
+    /** Period of the clock pings sent to each unicast destination, 0 = off.
+        Once a destination has answered, absolute bundle timetags sent to it
+        are converted to its clock. Only paced bounces carry absolute
+        timetags, realtime bundles are stamped "immediately", so pings are
+        only sent while the offline mode is OfflineMode::paceToWallClock. */
+    void setClockSyncInterval(int milliseconds) { _clockSyncIntervalMs = milliseconds; }
+
+    /** Clock estimate for the default destination (0) or routing rule n (n).
+        Returns false until that destination has answered a ping. */
+    bool getClockEstimate(size_t destination, double& offsetSeconds, double& drift);
+
+    /** Asks the sender thread to send a snapshot on its next tick. */
+    void requestSnapshot() { _snapshotRequested = true; }
+
+    /** Replaces the routing rules. Rule destinations are connected here, then
+        the compiled table is handed to the audio thread for its next block.
+        Events routed by the previous table keep their old destinations. */
+    void setRoutingRules(const std::vector<RoutingRule>& rules);
+
+    //==============================================================================
+    /** What to do with events rendered while the host runs non-realtime. */
+    void setOfflineMode(OfflineMode mode) { _offlineMode = mode; }
+    OfflineMode getOfflineMode() const { return _offlineMode.load(); }
+
+    /** Folder for OfflineMode::writeToFile logs. */
+    void setOfflineLogFolder(const std::string& folder);
+
+    /** Forgets every held note, e.g. when playback is reset. */
+    void resetNoteState();
+
+    //==============================================================================
+    // Audio thread
+    /** Picks up the latest routing table and the block timing.
+        Call once at the start of each block. */
+    void beginBlock(const BlockContext& context = {}) {
+        _routingTable = _routingExchange.acquire();
+        if (context.isNonRealtime && ! _block.isNonRealtime) {
+            // A render starts: with every value, and with its first event marked so
+            // the sender thread anchors the pacer and opens a log for it alone.
+            _offlineParameterValues.fill(std::numeric_limits<float>::quiet_NaN());
+            _isNewRender = true;
+        }
+        _block = context;
+    }
+
+    /** Queues an event for sending. Never blocks; returns false if the queue is full.
+        The held-note table follows notes as they are sent, so notes that are
+        suppressed, only logged to a file or dropped leave it unchanged. */
+    bool pushEvent(const MidiEvent& event);
+
+    /** Copies a SysEx message (F0 ... F7) into the preallocated pool and queues it.
+        Never blocks or allocates; returns false if the pool or the queue is full. */
+    bool pushSysEx(const uint8_t* data, int size, int samplePosition);
+
+    /** Reports a streamed parameter's value; call once per parameter and block.
+        Unchanged values cost one relaxed load. While rendering offline, changes
+        are queued with their song time and follow the offline mode like notes
+        (unless it is OfflineMode::sendImmediately). */
+    void setParameterValue(int index, float value) {
+        if (_block.isNonRealtime && _offlineMode.load(std::memory_order_relaxed) != OfflineMode::sendImmediately)
+            pushOfflineParameter(index, value);
+        else
+            _parameterStream.setValue(index, value);
+    }
+
+    //==============================================================================
+    /** Encodes and sends everything queued so far. Called by the sender thread,
+        public so that tests can drive the engine deterministically. */
+    void dispatchPending();
+
+    /** Reads the held-note table and sends each destination the notes routed
+        to it as /<mainId>/noteState. */
+    bool sendSnapshot();
+
+    /** Sends the streamed parameter values that are due. Called by the sender
+        thread on every tick, public so that tests can pass their own clock. */
+    void streamParameters(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    uint64_t getNumSent() const { return _numSent.load(); }
+    uint64_t getNumSendFailures() const { return _numSendFailures.load(); }
+    uint64_t getNumDropped() const { return _numDropped.load(); }
+    size_t getNumPacedPending();
+    std::string getOfflineLogPath();
+    int getBoundSyncPort() const { return _boundSyncPort.load(); }
+
+private:
+    void pushOfflineParameter(int index, float value);
+    void run();
+    void sendPacket();
+    void sendPacket(UdpSender& sender, const OscPacketWriter& writer);
+    void updateSyncSocket();
+    void pollSyncRequests(int timeoutMs);
+    void dispatch(const MidiEvent& event, uint64_t timeTag, const uint8_t* sysEx = nullptr);
+    void dispatchOffline(const MidiEvent& event);
+    void finishOfflineRender();
+    uint64_t pacedTimeTag(OfflinePacer::Clock::time_point dueTime) const;
+    void dispatchSysEx(const MidiEvent& event, const uint8_t* data);
+    void dispatchParameter(const MidiEvent& event, uint64_t timeTag);
+    void logSysEx(const MidiEvent& event, const MidiOscEncoder& encoder);
+    void syncClocks();
+    void syncClock(UdpSender& sender, const MidiOscEncoder& encoder, ClockEstimator& clock, bool sendPing);
+
+    struct Route {
+        std::unique_ptr<MidiOscEncoder> encoder;   // nullptr = default main ID
+        std::unique_ptr<UdpSender> sender;         // nullptr = default destination
+        std::unique_ptr<ClockEstimator> clock;     // set along with a unicast sender
+        size_t destination = 0;   // first route with the same host, port and main ID, 0 = the default
+    };
+
+    /** The routes of one setRoutingRules() call, kept until no queued or
+        paced event can refer to them any more. */
+    struct RouteSet {
+        uint16_t generation = 0;
+        std::vector<RoutingRule> rules;
+        RoutingTable table;
+        std::vector<Route> routes;
+    };
+
+    static constexpr size_t maxRouteSets = 8;
+
+    void buildRoutes(RouteSet& set);
+    const Route* findRoute(const MidiEvent& event);
+    ClockEstimator* defaultClock() { return _isDefaultUnicast ? &_clock : nullptr; }
+
+    /** Calls function(destination, encoder, sender, clock) once for the
+        default destination and once for each distinct routed one. clock is
+        nullptr for multicast groups. */
+    template <typename Function>
+    void forEachDestination(Function&& function);
+
+    SpscQueue<MidiEvent> _queue;
+    SysExPool _sysExPool;
+    ActiveNoteState _noteState;   // read and written under _lock
+    RoutingTableExchange _routingExchange;
+    const RoutingTable* _routingTable = nullptr;   // audio thread
+    BlockContext _block;                           // audio thread
+    std::array<float, ParameterStream::maxParameters> _offlineParameterValues;   // audio thread
+    bool _isNewRender = false;                     // audio thread, until the render's first event is queued
+    std::atomic<OfflineMode> _offlineMode { DEFAULT_OFFLINE_MODE };
+    ParameterStream _parameterStream;   // setValue() is lock free, the rest is under _lock
+
+    std::mutex _lock;   // guards everything below up to the thread
+    std::string _host;
+    int _port;
+    MulticastOptions _multicastOptions;
+    MidiOscEncoder _encoder;
+    OscPacketWriter _writer;
+    OscPacketWriter _snapshotWriter;
+    ActiveNoteState::Snapshot _snapshot;
+    ActiveNoteState::Snapshot _routedSnapshot;
+    UdpSender _sender;
+    std::vector<std::string> _parameterNames;
+    std::deque<RouteSet> _routeSets;   // oldest first, the back holds the current rules
+    uint16_t _nextRoutingGeneration = 1;
+    std::string _offlineLogFolder;
+    OfflinePacer _pacer;
+    OscFileLog _fileLog;
+    double _lastLoggedTime = 0.0;
+    uint32_t _nextSysExId = 0;
+    ClockEstimator _clock;
+    bool _isDefaultUnicast = true;   // the default destination is not a multicast group
+    std::chrono::steady_clock::time_point _lastClockPing;
+
+    // Only touched by the sender thread
+    UdpReceiver _syncReceiver;
+    int _appliedSyncPort = 0;
+    std::vector<uint8_t> _receiveBuffer;
+    std::chrono::steady_clock::time_point _lastSnapshotTime;
+
+    std::atomic<int> _syncPort { DEFAULT_SYNC_PORT };
+    std::atomic<int> _boundSyncPort { 0 };
+    std::atomic<int> _snapshotIntervalMs { DEFAULT_SNAPSHOT_INTERVAL_MS };
+    std::atomic<bool> _snapshotRequested { false };
+    std::atomic<int> _clockSyncIntervalMs { DEFAULT_CLOCK_SYNC_INTERVAL_MS };
+
+    std::atomic<bool> _isConnected { false };
+    std::atomic<bool> _multicastEnabled { false };
+    std::atomic<uint64_t> _numSent { 0 };
+    std::atomic<uint64_t> _numSendFailures { 0 };
+    std::atomic<uint64_t> _numDropped { 0 };
+
+    std::atomic<bool> _running { true };
+    std::thread _thread;
+};
+
+} // namespace midisender
@@ -0,0 +1,294 @@
+//
+//  OscPacket.cpp
+//  MidiSender
+//
+
+#include "OscPacket.h"
+
+#include <cstring>
+
+namespace midisender
+{
+
+namespace
+{
+size_t paddedSize(size_t numBytes) {
+    return (numBytes + 3) & ~size_t(3);
+}
+
+uint32_t readUInt32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+uint64_t readUInt64(const uint8_t* p) {
+    return (uint64_t(readUInt32(p)) << 32) | readUInt32(p + 4);
+}
+
+/** Reads a null-terminated, 4-byte padded OSC string. Returns the padded length or 0 on error. */
+size_t readPaddedString(const uint8_t* data, size_t size, std::string_view& value) {
+    const auto* end = static_cast<const uint8_t*>(std::memchr(data, 0, size));
+    if (end == nullptr)
+        return 0;
+    const auto length = size_t(end - data);
+    const auto padded = paddedSize(length + 1);
+    if (padded > size)
+        return 0;
+    value = std::string_view(reinterpret_cast<const char*>(data), length);
+    return padded;
+}
+}
+
+//==============================================================================
+OscPacketWriter::OscPacketWriter(size_t capacity) : _buffer(capacity) {}
+
+void OscPacketWriter::reset() {
+    _size = 0;
+    _messageSizeOffset = 0;
+    _inBundle = false;
+    _inMessage = false;
+    _overflowed = false;
+}
+
+bool OscPacketWriter::beginBundle(uint64_t timeTag) {
+    if (_size != 0)
+        return false;
+    _inBundle = true;
+    return writePaddedString("#bundle") && writeUInt64(timeTag);
+}
+
+bool OscPacketWriter::beginMessage(std::string_view address, std::string_view typeTags) {
+    if (_inMessage || (! _inBundle && _size != 0))
+        return false;
+
+    if (_inBundle) {
+        _messageSizeOffset = _size;
+        if (! writeUInt32(0))
+            return false;
+    }
+    _inMessage = true;
+
+    if (! writeBytes(address.data(), address.size()) || ! writeBytes("", 1) || ! pad())
+        return false;
+    return writeBytes(",", 1) && writeBytes(typeTags.data(), typeTags.size()) && writeBytes("", 1) && pad();
+}
+
+bool OscPacketWriter::addInt32(int32_t value) {
+    return writeUInt32(uint32_t(value));
+}
+
+bool OscPacketWriter::addFloat32(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return writeUInt32(bits);
+}
+
+bool OscPacketWriter::addString(std::string_view value) {
+    return writePaddedString(value);
+}
+
+bool OscPacketWriter::addBlob(const void* data, size_t numBytes) {
+    return writeUInt32(uint32_t(numBytes)) && writeBytes(data, numBytes) && pad();
+}
+
+bool OscPacketWriter::addTimeTag(uint64_t timeTag) {
+    return writeUInt64(timeTag);
+}
+
+uint8_t* OscPacketWriter::addBlobSpace(size_t numBytes) {
+    if (! writeUInt32(uint32_t(numBytes)))
+        return nullptr;
+    if (_size + paddedSize(numBytes) > _buffer.size()) {
+        _overflowed = true;
+        return nullptr;
+    }
+    auto* start = _buffer.data() + _size;
+    std::memset(start, 0, paddedSize(numBytes));
+    _size += paddedSize(numBytes);
+    return start;
+}
+
+bool OscPacketWriter::endMessage() {
+    if (! _inMessage || _overflowed)
+        return false;
+    _inMessage = false;
+
+    if (_inBundle) {
+        const auto elementSize = uint32_t(_size - _messageSizeOffset - 4);
+        auto* p = _buffer.data() + _messageSizeOffset;
+        p[0] = uint8_t(elementSize >> 24);
+        p[1] = uint8_t(elementSize >> 16);
+        p[2] = uint8_t(elementSize >> 8);
+        p[3] = uint8_t(elementSize);
+    }
+    return true;
+}
+
+bool OscPacketWriter::writeBytes(const void* data, size_t numBytes) {
+    if (_overflowed || _size + numBytes > _buffer.size()) {
+        _overflowed = true;
+        return false;
+    }
+    if (numBytes > 0)
+        std::memcpy(_buffer.data() + _size, data, numBytes);
+    _size += numBytes;
+    return true;
+}
+
+bool OscPacketWriter::writePaddedString(std::string_view value) {
+    return writeBytes(value.data(), value.size()) && writeBytes("", 1) && pad();
+}
+
+bool OscPacketWriter::writeUInt32(uint32_t value) {
+    const uint8_t bytes[4] = { uint8_t(value >> 24), uint8_t(value >> 16), uint8_t(value >> 8), uint8_t(value) };
+    return writeBytes(bytes, sizeof(bytes));
+}
+
+bool OscPacketWriter::writeUInt64(uint64_t value) {
+    return writeUInt32(uint32_t(value >> 32)) && writeUInt32(uint32_t(value));
+}
+
+bool OscPacketWriter::pad() {
+    static const uint8_t zeros[4] = {};
+    return writeBytes(zeros, paddedSize(_size) - _size);
+}
+
+//==============================================================================
+bool OscMessageView::locate(size_t index, char expectedType, const uint8_t*& start, size_t& available) const {
+    if (getType(index) != expectedType)
+        return false;
+
+    size_t offset = 0;
+    for (size_t i = 0; i < index; ++i) {
+        const char type = typeTags[i];
+        if (type == 'i' || type == 'f') {
+            offset += 4;
+        } else if (type == 'h' || type == 'd' || type == 't') {
+            offset += 8;
+        } else if (type == 's' || type == 'S') {
+            std::string_view skipped;
+            if (offset >= _argumentsSize)
+                return false;
+            const auto length = readPaddedString(_arguments + offset, _argumentsSize - offset, skipped);
+            if (length == 0)
+                return false;
+            offset += length;
+        } else if (type == 'b') {
+            if (offset + 4 > _argumentsSize)
+                return false;
+            offset += 4 + paddedSize(readUInt32(_arguments + offset));
+        } else if (type != 'T' && type != 'F' && type != 'N' && type != 'I') {
+            return false;
+        }
+    }
+
+    if (offset > _argumentsSize)
+        return false;
+    start = _arguments + offset;
+    available = _argumentsSize - offset;
+    return true;
+}
+
+bool OscMessageView::getInt32(size_t index, int32_t& value) const {
+    const uint8_t* p;
+    size_t available;
+    if (! locate(index, 'i', p, available) || available < 4)
+        return false;
+    value = int32_t(readUInt32(p));
+    return true;
+}
+
+bool OscMessageView::getFloat32(size_t index, float& value) const {
+    const uint8_t* p;
+    size_t available;
+    if (! locate(index, 'f', p, available) || available < 4)
+        return false;
+    const uint32_t bits = readUInt32(p);
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+bool OscMessageView::getString(size_t index, std::string_view& value) const {
+    const uint8_t* p;
+    size_t available;
+    if (! locate(index, 's', p, available) || available == 0)
+        return false;
+    return readPaddedString(p, available, value) != 0;
+}
+
+bool OscMessageView::getBlob(size_t index, const uint8_t*& data, size_t& numBytes) const {
+    const uint8_t* p;
+    size_t available;
+    if (! locate(index, 'b', p, available) || available < 4)
+        return false;
+    numBytes = readUInt32(p);
+    if (numBytes > available - 4)
+        return false;
+    data = p + 4;
+    return true;
+}
+
+bool OscMessageView::getTimeTag(size_t index, uint64_t& value) const {
+    const uint8_t* p;
+    size_t available;
+    if (! locate(index, 't', p, available) || available < 8)
+        return false;
+    value = readUInt64(p);
+    return true;
+}
+
+//==============================================================================
+bool OscPacketReader::parse(const uint8_t* data, size_t size, const MessageCallback& callback) {
+    return parseElement(data, size, oscTimeTagImmediately, callback);
+}
+
+bool OscPacketReader::parseElement(const uint8_t* data, size_t size, uint64_t timeTag, const MessageCallback& callback) {
+    if (size < 4 || (size & 3) != 0)
+        return false;
+
+    if (data[0] == '#') {
+        std::string_view header;
+        const auto headerSize = readPaddedString(data, size, header);
+        if (headerSize == 0 || header != "#bundle" || headerSize + 8 > size)
+            return false;
+
+        const auto bundleTimeTag = readUInt64(data + headerSize);
+        size_t offset = headerSize + 8;
+        while (offset < size) {
+            if (offset + 4 > size)
+                return false;
+            const auto elementSize = readUInt32(data + offset);
+            offset += 4;
+            if (elementSize > size - offset)
+                return false;
+            if (! parseElement(data + offset, elementSize, bundleTimeTag, callback))
+                return false;
+            offset += elementSize;
+        }
+        return true;
+    }
+
+    if (data[0] != '/')
+        return false;
+
+    OscMessageView message;
+    const auto addressSize = readPaddedString(data, size, message.address);
+    if (addressSize == 0)
+        return false;
+
+    size_t offset = addressSize;
+    if (offset < size && data[offset] == ',') {
+        std::string_view tags;
+        const auto tagsSize = readPaddedString(data + offset, size - offset, tags);
+        if (tagsSize == 0)
+            return false;
+        message.typeTags = tags.substr(1);
+        offset += tagsSize;
+    }
+
+    message._arguments = data + offset;
+    message._argumentsSize = size - offset;
+    callback(message, timeTag);
+    return true;
+}
+
+} // namespace midisender
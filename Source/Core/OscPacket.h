@@ -0,0 +1,112 @@
+//
+//  OscPacket.h
+//  MidiSender
+//
+//  Minimal OSC 1.0 packet writer and reader working on caller-owned memory.
+//  The writer never allocates after construction, which keeps encoding off
+//  the heap on the sender thread; the reader returns views into the packet.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace midisender
+{
+
+/** OSC timetag meaning "process immediately", as used by juce::OSCTimeTag. */
+constexpr uint64_t oscTimeTagImmediately = 1;
+
+/** Converts a wall-clock time to an OSC (NTP format) timetag. */
+inline uint64_t oscTimeTagFromSystemTime(std::chrono::system_clock::time_point time) {
+    constexpr uint64_t secondsFrom1900To1970 = 2208988800ull;
+    const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    const auto seconds = uint64_t(sinceEpoch / 1000000000) + secondsFrom1900To1970;
+    const auto fraction = (uint64_t(sinceEpoch % 1000000000) << 32) / 1000000000;
+    return (seconds << 32) | fraction;
+}
+
+class OscPacketWriter {
+public:
+    explicit OscPacketWriter(size_t capacity = 1536);
+
+    void reset();
+
+    /** Starts a bundle. Must be the first call after reset(). */
+    bool beginBundle(uint64_t timeTag = oscTimeTagImmediately);
+
+    /** Starts a message. Inside a bundle a size prefix is reserved and
+        patched by endMessage(). typeTags is given without the leading ','. */
+    bool beginMessage(std::string_view address, std::string_view typeTags);
+    bool addInt32(int32_t value);
+    bool addFloat32(float value);
+    bool addString(std::string_view value);
+    bool addBlob(const void* data, size_t numBytes);
+    bool addTimeTag(uint64_t timeTag);
+
+    /** Reserves a blob argument and returns where to write its contents,
+        or nullptr if it does not fit. Saves a copy through a scratch buffer. */
+    uint8_t* addBlobSpace(size_t numBytes);
+    bool endMessage();
+
+    const uint8_t* data() const { return _buffer.data(); }
+    size_t size() const { return _size; }
+    size_t capacity() const { return _buffer.size(); }
+    bool hasOverflowed() const { return _overflowed; }
+
+private:
+    bool writeBytes(const void* data, size_t numBytes);
+    bool writePaddedString(std::string_view value);
+    bool writeUInt32(uint32_t value);
+    bool writeUInt64(uint64_t value);
+    bool pad();
+
+    std::vector<uint8_t> _buffer;
+    size_t _size = 0;
+    size_t _messageSizeOffset = 0;
+    bool _inBundle = false;
+    bool _inMessage = false;
+    bool _overflowed = false;
+};
+
+/** Read-only view of one decoded OSC message. */
+class OscMessageView {
+public:
+    std::string_view address;
+    std::string_view typeTags;   // without the leading ','
+
+    size_t numArguments() const { return typeTags.size(); }
+    char getType(size_t index) const { return index < typeTags.size() ? typeTags[index] : 0; }
+
+    bool getInt32(size_t index, int32_t& value) const;
+    bool getFloat32(size_t index, float& value) const;
+    bool getString(size_t index, std::string_view& value) const;
+    bool getBlob(size_t index, const uint8_t*& data, size_t& numBytes) const;
+    bool getTimeTag(size_t index, uint64_t& value) const;
+
+private:
+    friend class OscPacketReader;
+    bool locate(size_t index, char expectedType, const uint8_t*& start, size_t& available) const;
+
+    const uint8_t* _arguments = nullptr;
+    size_t _argumentsSize = 0;
+};
+
+class OscPacketReader {
+public:
+    using MessageCallback = std::function<void(const OscMessageView&, uint64_t timeTag)>;
+
+    /** Walks a packet (message or nested bundles) and calls back for each message.
+        Returns false if the packet is malformed. */
+    static bool parse(const uint8_t* data, size_t size, const MessageCallback& callback);
+
+private:
+    static bool parseElement(const uint8_t* data, size_t size, uint64_t timeTag, const MessageCallback& callback);
+};
+
+} // namespace midisender
@@ -0,0 +1,27 @@
+//
+//  ParameterStream.cpp
+//  MidiSender
+//
+
+#include "ParameterStream.h"
+
+#include <algorithm>
+
+namespace midisender
+{
+
+ParameterStream::ParameterStream() {
+    for (auto& value : _values)
+        value.store(0.0f, std::memory_order_relaxed);
+}
+
+void ParameterStream::setParameters(const std::vector<StreamedParameter>& parameters) {
+    _parameters.assign(parameters.begin(), parameters.begin() + std::min<size_t>(parameters.size(), maxParameters));
+    _states.fill({});
+
+    const auto count = _parameters.size();
+    const uint64_t all = count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+    _changed.fetch_or(all, std::memory_order_release);
+}
+
+} // namespace midisender
@@ -0,0 +1,121 @@
+//
+//  ParameterStream.h
+//  MidiSender
+//
+//  Streams automatable parameter values. The audio thread reports the value
+//  of every parameter once per block; only changes touch shared state (one
+//  atomic store and one bit in a mask). The sender thread then smooths each
+//  value and sends it no faster than the parameter's rate cap. The last
+//  value of a burst is always sent once the cap allows it.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace midisender
+{
+
+struct StreamedParameter {
+    std::string name;            // sent as /<mainId>/param/<name>
+    float maxRateHz = 60.0f;     // 0 = no cap
+    float smoothingMs = 0.0f;    // one-pole time constant, 0 = jump to the new value
+};
+
+class ParameterStream {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int maxParameters = 64;
+
+    ParameterStream();
+
+    //==============================================================================
+    /** Sender side. Replaces the parameter list; every parameter is sent again
+        with its latest value. */
+    void setParameters(const std::vector<StreamedParameter>& parameters);
+    const std::vector<StreamedParameter>& getParameters() const { return _parameters; }
+
+    //==============================================================================
+    /** Audio thread, once per parameter and block. */
+    void setValue(int index, float value) {
+        if (index < 0 || index >= maxParameters)
+            return;
+        auto& slot = _values[(size_t) index];
+        if (slot.load(std::memory_order_relaxed) == value)
+            return;
+        slot.store(value, std::memory_order_relaxed);
+        _changed.fetch_or(uint64_t(1) << index, std::memory_order_release);
+    }
+
+    //==============================================================================
+    /** Sender thread. Calls send(index, value) for every value due at `now`. */
+    template <typename SendFunction>
+    void update(Clock::time_point now, SendFunction&& send) {
+        const auto changed = _changed.exchange(0, std::memory_order_acquire);
+        const float elapsedMs = _hasUpdated ? std::chrono::duration<float, std::milli>(now - _lastUpdate).count() : 0.0f;
+        _lastUpdate = now;
+        _hasUpdated = true;
+
+        for (size_t i = 0; i < _parameters.size(); ++i) {
+            auto& state = _states[i];
+            if ((changed >> i) & 1) {
+                state.target = _values[i].load(std::memory_order_relaxed);
+                state.isPending = true;
+                if (! state.hasSent)
+                    state.current = state.target;
+            }
+            if (! state.isPending)
+                continue;
+
+            const auto& parameter = _parameters[i];
+            if (parameter.smoothingMs > 0.0f && elapsedMs > 0.0f) {
+                state.current += (state.target - state.current) * (1.0f - std::exp(-elapsedMs / parameter.smoothingMs));
+                if (std::abs(state.target - state.current) < settleThreshold)
+                    state.current = state.target;
+            } else if (parameter.smoothingMs <= 0.0f) {
+                state.current = state.target;
+            }
+
+            if (state.hasSent && parameter.maxRateHz > 0.0f
+                && now - state.lastSendTime < std::chrono::duration<float>(1.0f / parameter.maxRateHz))
+                continue;
+
+            if (! state.hasSent || state.current != state.lastSent) {
+                send((int) i, state.current);
+                state.lastSent = state.current;
+                state.lastSendTime = now;
+                state.hasSent = true;
+            }
+            state.isPending = state.current != state.target;
+        }
+    }
+
+private:
+    static constexpr float settleThreshold = 1.0e-4f;
+
+    struct State {
+        float target = 0.0f;
+        float current = 0.0f;
+        float lastSent = 0.0f;
+        Clock::time_point lastSendTime;
+        bool hasSent = false;
+        bool isPending = false;
+    };
+
+    std::array<std::atomic<float>, maxParameters> _values;
+    std::atomic<uint64_t> _changed { 0 };
+
+    std::vector<StreamedParameter> _parameters;
+    std::array<State, maxParameters> _states;
+    Clock::time_point _lastUpdate;
+    bool _hasUpdated = false;
+};
+
+} // namespace midisender
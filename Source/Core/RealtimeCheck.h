@@ -0,0 +1,61 @@
+//
+//  RealtimeCheck.h
+//  MidiSender
+//
+//  Marks code that runs on the audio thread. When MIDISENDER_REALTIME_CHECKS
+//  is defined, each thread counts how deep it is inside such scopes so an
+//  instrumented build (see Tests/RealtimeChecker.cpp) can flag allocations,
+//  locks and blocking syscalls made from there. Otherwise the macro is empty.
+//
+
+#pragma once
+
+namespace midisender
+{
+namespace realtime
+{
+
+#if defined(MIDISENDER_REALTIME_CHECKS)
+
+inline thread_local int scopeDepth = 0;
+
+inline bool isInRealtimeScope() { return scopeDepth > 0; }
+
+struct ScopedRealtimeSection {
+    ScopedRealtimeSection() { ++scopeDepth; }
+    ~ScopedRealtimeSection() { --scopeDepth; }
+
+    ScopedRealtimeSection(const ScopedRealtimeSection&) = delete;
+    ScopedRealtimeSection& operator=(const ScopedRealtimeSection&) = delete;
+};
+
+/** Lifts the checks for the rest of the scope, e.g. around a call that is
+    known to block but is tolerated for now. */
+struct ScopedNonRealtimeSection {
+    ScopedNonRealtimeSection() : _savedDepth(scopeDepth) { scopeDepth = 0; }
+    ~ScopedNonRealtimeSection() { scopeDepth = _savedDepth; }
+
+    ScopedNonRealtimeSection(const ScopedNonRealtimeSection&) = delete;
+    ScopedNonRealtimeSection& operator=(const ScopedNonRealtimeSection&) = delete;
+
+private:
+    int _savedDepth;
+};
+
+#define MIDISENDER_REALTIME_SCOPE \
+    const midisender::realtime::ScopedRealtimeSection midisenderRealtimeSection_
+
+#define MIDISENDER_NON_REALTIME_SCOPE \
+    const midisender::realtime::ScopedNonRealtimeSection midisenderNonRealtimeSection_
+
+#else
+
+inline bool isInRealtimeScope() { return false; }
+
+#define MIDISENDER_REALTIME_SCOPE
+#define MIDISENDER_NON_REALTIME_SCOPE
+
+#endif
+
+} // namespace realtime
+} // namespace midisender
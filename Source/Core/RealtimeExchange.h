@@ -0,0 +1,64 @@
+//
+//  RealtimeExchange.h
+//  MidiSender
+//
+//  Hands immutable objects (compiled tables) from the message thread to the
+//  audio thread. The audio thread never frees memory: a replaced object is
+//  deleted by a later publish() once the audio thread has started a new
+//  block since the swap.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace midisender
+{
+
+template <typename ObjectType>
+class RealtimeExchange {
+public:
+    RealtimeExchange() = default;
+    ~RealtimeExchange() { delete _current.exchange(nullptr); }
+
+    RealtimeExchange(const RealtimeExchange&) = delete;
+    RealtimeExchange& operator=(const RealtimeExchange&) = delete;
+
+    /** Message thread. */
+    void publish(std::unique_ptr<ObjectType> object) {
+        std::unique_ptr<ObjectType> previous(_current.exchange(object.release()));
+        if (previous != nullptr)
+            _retired.push_back({ std::move(previous), _numAcquires.load() });
+
+        // A block that could still see a retired object acquired it no later
+        // than the swap; any acquire after that means the block has finished.
+        const auto numAcquires = _numAcquires.load();
+        _retired.erase(std::remove_if(_retired.begin(), _retired.end(), [numAcquires](const Retired& retired) {
+                           return numAcquires > retired.acquiresAtSwap;
+                       }),
+                       _retired.end());
+    }
+
+    /** Audio thread, once per block. Returns the object to use for the whole
+        block, or nullptr if none was ever published. */
+    const ObjectType* acquire() {
+        _numAcquires.fetch_add(1);
+        return _current.load();
+    }
+
+private:
+    struct Retired {
+        std::unique_ptr<ObjectType> object;
+        uint64_t acquiresAtSwap;
+    };
+
+    std::atomic<ObjectType*> _current { nullptr };
+    std::atomic<uint64_t> _numAcquires { 0 };
+    std::vector<Retired> _retired;   // message thread only
+};
+
+} // namespace midisender
@@ -0,0 +1,153 @@
+//
+//  RoutingTable.cpp
+//  MidiSender
+//
+
+#include "RoutingTable.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace midisender
+{
+
+namespace
+{
+bool parseInt(const std::string& text, int minimum, int maximum, int& value) {
+    if (text.empty())
+        return false;
+    char* end = nullptr;
+    const long parsed = std::strtol(text.c_str(), &end, 10);
+    if (*end != 0 || parsed < minimum || parsed > maximum)
+        return false;
+    value = (int) parsed;
+    return true;
+}
+
+bool parseTypes(const std::string& text, uint8_t& types) {
+    types = 0;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item == "notes")
+            types |= RoutingRule::notes;
+        else if (item == "other")
+            types |= RoutingRule::otherMessages;
+        else if (item == "all")
+            types |= RoutingRule::allMessages;
+        else
+            return false;
+    }
+    return types != 0;
+}
+
+bool parseDestination(const std::string& text, RoutingRule& rule, std::string& reason) {
+    if (text == "*")
+        return true;
+
+    auto colon = std::string::npos;
+    if (text.front() == '[') {
+        const auto close = text.find(']');
+        if (close == std::string::npos || close == 1 || (close + 1 < text.size() && text[close + 1] != ':')) {
+            reason = "expected [address] or [address]:port";
+            return false;
+        }
+        rule.host = text.substr(1, close - 1);
+        if (close + 1 < text.size())
+            colon = close + 1;
+    } else {
+        colon = text.find(':');
+        if (colon != std::string::npos && text.find(':', colon + 1) != std::string::npos) {
+            reason = "put IPv6 addresses in brackets, e.g. [ff02::1]:9000";
+            return false;
+        }
+        rule.host = text.substr(0, colon);
+    }
+    return colon == std::string::npos || parseInt(text.substr(colon + 1), 1, 65535, rule.port);
+}
+
+bool parseRule(const std::string& line, RoutingRule& rule, std::string& reason) {
+    std::stringstream stream(line);
+    std::string channel, keys, types, destination, mainId, extra;
+    if (! (stream >> channel >> keys >> types >> destination >> mainId) || (stream >> extra))
+        return false;
+
+    if (channel != "*" && ! parseInt(channel, 1, 16, rule.channel))
+        return false;
+
+    const auto dash = keys.find('-');
+    if (dash == std::string::npos) {
+        if (! parseInt(keys, 0, 127, rule.lowKey))
+            return false;
+        rule.highKey = rule.lowKey;
+    } else if (! parseInt(keys.substr(0, dash), 0, 127, rule.lowKey)
+               || ! parseInt(keys.substr(dash + 1), 0, 127, rule.highKey)
+               || rule.lowKey > rule.highKey) {
+        return false;
+    }
+
+    if (mainId != "*")
+        rule.mainId = mainId;
+
+    if (! parseTypes(types, rule.types))
+        return false;
+    if (rule.types == RoutingRule::otherMessages && rule.channel != 0) {
+        reason = "SysEx has no channel, use * for other";
+        return false;
+    }
+    return parseDestination(destination, rule, reason);
+}
+}
+
+bool parseRoutingRules(std::string_view text, std::vector<RoutingRule>& rules, std::string& error) {
+    rules.clear();
+    std::stringstream stream { std::string(text) };
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(stream, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        RoutingRule rule;
+        std::string reason;
+        if (! parseRule(line, rule, reason)) {
+            error = "line " + std::to_string(lineNumber) + ": " + line;
+            if (! reason.empty())
+                error += " (" + reason + ")";
+            return false;
+        }
+        rules.push_back(rule);
+    }
+    return true;
+}
+
+//==============================================================================
+void RoutingTable::compile(const std::vector<RoutingRule>& rules, uint16_t generation) {
+    _routes.fill(defaultRoute);
+    _otherRoute = defaultRoute;
+    _generation = generation;
+
+    // Walk backwards so that earlier rules overwrite later ones.
+    const auto numRules = std::min(rules.size(), maxRules);
+    for (size_t i = numRules; i-- > 0;) {
+        const auto& rule = rules[i];
+        const auto route = uint8_t(i + 1);
+        const int firstChannel = rule.channel == 0 ? 0 : rule.channel - 1;
+        const int lastChannel = rule.channel == 0 ? 15 : rule.channel - 1;
+
+        if ((rule.types & RoutingRule::notes) != 0) {
+            for (int channel = firstChannel; channel <= lastChannel; ++channel) {
+                auto* row = _routes.data() + (size_t(channel) << 7);
+                std::fill(row + rule.lowKey, row + rule.highKey + 1, route);
+            }
+        }
+        if ((rule.types & RoutingRule::otherMessages) != 0 && rule.channel == 0)
+            _otherRoute = route;
+    }
+}
+
+} // namespace midisender
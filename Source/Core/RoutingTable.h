@@ -0,0 +1,82 @@
+//
+//  RoutingTable.h
+//  MidiSender
+//
+//  Maps (channel, key range, message type) to an output route. Rules are
+//  compiled into a flat 16 x 128 note table plus one route for everything
+//  else, so the audio thread pays a single array load per event no matter
+//  how many rules there are.
+//
+
+#pragma once
+
+#include "MidiEvent.h"
+#include "RealtimeExchange.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace midisender
+{
+
+struct RoutingRule {
+    enum TypeMask : uint8_t {
+        notes = 1,
+        otherMessages = 2,   // everything else the engine sends, i.e. SysEx; has no channel or key
+        allMessages = 3
+    };
+
+    int channel = 0;            // 1..16, 0 = any
+    int lowKey = 0;             // note number
+    int highKey = 127;
+    uint8_t types = allMessages;
+    std::string host;           // empty = default destination host
+    int port = 0;               // 0 = default destination port
+    std::string mainId;         // empty = default main ID
+
+    bool usesDefaultDestination() const { return host.empty() && port == 0; }
+};
+
+/** Parses one rule per line:
+        <channel|*> <low>-<high> <notes|other|all>[,...] <host:port|host|:port|*> <mainId|*>
+    e.g. "1 0-59 notes 10.0.0.2:9001 left". '#' starts a comment. IPv6 hosts
+    go in brackets, "[ff02::1]:9001". Messages other than notes have no
+    channel, so only rules for any channel (*) route them, and an `other`
+    rule with a channel number is rejected. Returns false and describes the
+    first bad line in error. */
+bool parseRoutingRules(std::string_view text, std::vector<RoutingRule>& rules, std::string& error);
+
+class RoutingTable {
+public:
+    static constexpr uint8_t defaultRoute = 0;
+    static constexpr size_t maxRules = 254;
+
+    /** Rule i maps to route i + 1; the first matching rule wins and anything
+        unmatched goes to defaultRoute. Rules past maxRules are ignored.
+        The generation is copied into every event routed by this table. */
+    void compile(const std::vector<RoutingRule>& rules, uint16_t generation = 0);
+
+    uint16_t getGeneration() const { return _generation; }
+
+    uint8_t lookup(const MidiEvent& event) const {
+        return event.isNote() ? lookupNote(event.channel, event.data1) : _otherRoute;
+    }
+
+    /** channel is 1..16. */
+    uint8_t lookupNote(int channel, int note) const {
+        return _routes[size_t(((channel - 1) & 0x0f) << 7 | (note & 0x7f))];
+    }
+
+private:
+    std::array<uint8_t, 16 * 128> _routes {};
+    uint8_t _otherRoute = defaultRoute;
+    uint16_t _generation = 0;
+};
+
+using RoutingTableExchange = RealtimeExchange<RoutingTable>;
+
+} // namespace midisender
@@ -0,0 +1,221 @@
+//
+//  SoakMonitor.cpp
+//  MidiSender
+//
+
+#include "SoakMonitor.h"
+
+#include <cmath>
+#include <cstdio>
+
+#if defined(__linux__)
+ #include <unistd.h>
+#else
+ #include <sys/resource.h>
+#endif
+
+namespace midisender
+{
+
+namespace
+{
+constexpr size_t subBuckets = 8;
+constexpr const char* logHeader =
+    "# elapsed_s rss_kb blocks p50_us p99_us max_us generated sent send_failures failure_rate dropped\n";
+
+double percentile(const std::array<uint64_t, SoakMonitor::numBuckets>& counts, uint64_t total, double fraction) {
+    if (total == 0)
+        return 0.0;
+    const auto rank = (uint64_t) std::ceil(fraction * (double) total);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank)
+            return (double) SoakMonitor::bucketUpperBound(i) / 1000.0;
+    }
+    return (double) SoakMonitor::bucketUpperBound(counts.size() - 1) / 1000.0;
+}
+}
+
+//==============================================================================
+size_t SoakMonitor::bucketFor(uint64_t nanoseconds) {
+    if (nanoseconds < subBuckets)
+        return (size_t) nanoseconds;
+    const int exponent = 63 - __builtin_clzll(nanoseconds);   // >= 3
+    const auto mantissa = (size_t) (nanoseconds >> (exponent - 3)) & (subBuckets - 1);
+    return std::min(size_t(exponent - 2) * subBuckets + mantissa, numBuckets - 1);
+}
+
+uint64_t SoakMonitor::bucketUpperBound(size_t bucket) {
+    const auto next = bucket + 1;
+    if (next < subBuckets)
+        return next;
+    const auto exponent = next / subBuckets + 2;
+    return (subBuckets + next % subBuckets) << (exponent - 3);
+}
+
+uint64_t SoakMonitor::getResidentMemoryKb() {
+#if defined(__linux__)
+    unsigned long long size = 0, resident = 0;
+    auto* file = std::fopen("/proc/self/statm", "r");
+    if (file == nullptr)
+        return 0;
+    const bool ok = std::fscanf(file, "%llu %llu", &size, &resident) == 2;
+    std::fclose(file);
+    return ok ? resident * (uint64_t) sysconf(_SC_PAGESIZE) / 1024 : 0;
+#else
+    // Peak rather than current usage, still enough to see steady growth
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+   #if defined(__APPLE__)
+    return (uint64_t) usage.ru_maxrss / 1024;
+   #else
+    return (uint64_t) usage.ru_maxrss;
+   #endif
+#endif
+}
+
+//==============================================================================
+SoakMonitor::SoakMonitor() {
+    for (auto& bucket : _buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+SoakMonitor::~SoakMonitor() {
+    stop();
+}
+
+bool SoakMonitor::start(const std::string& logPath, int intervalMs, size_t maxLogBytes) {
+    stop();
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _log.open(logPath, std::ios::out | std::ios::trunc);
+        if (! _log)
+            return false;
+        _log << logHeader << std::flush;
+        _logPath = logPath;
+        _logBytes = std::char_traits<char>::length(logHeader);
+        _maxLogBytes = maxLogBytes;
+        _summary = {};
+        _start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < numBuckets; ++i)
+            _lastBuckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        _maxNanoseconds.store(0, std::memory_order_relaxed);
+        _lastCounters = _source ? _source() : SoakCounters();
+        _stopRequested = false;
+    }
+
+    _thread = std::thread([this, intervalMs] { run(std::max(intervalMs, 1)); });
+    return true;
+}
+
+void SoakMonitor::stop() {
+    if (! _thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _stopRequested = true;
+    }
+    _wakeUp.notify_all();
+    _thread.join();
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _log.close();
+}
+
+void SoakMonitor::run(int intervalMs) {
+    std::unique_lock<std::mutex> lock(_lock);
+    while (! _wakeUp.wait_for(lock, std::chrono::milliseconds(intervalMs), [this] { return _stopRequested; })) {
+        lock.unlock();
+        const auto sample = takeSample();
+        lock.lock();
+        writeLine(sample);
+    }
+
+    // The last, shorter interval up to stop()
+    lock.unlock();
+    const auto sample = takeSample();
+    lock.lock();
+    writeLine(sample);
+}
+
+SoakSample SoakMonitor::takeSample() {
+    std::array<uint64_t, numBuckets> counts;
+    uint64_t blocks = 0;
+    const auto counters = _source ? _source() : SoakCounters();
+    const auto residentKb = getResidentMemoryKb();
+
+    std::lock_guard<std::mutex> lock(_lock);
+    for (size_t i = 0; i < numBuckets; ++i) {
+        const auto total = _buckets[i].load(std::memory_order_relaxed);
+        counts[i] = total - _lastBuckets[i];
+        _lastBuckets[i] = total;
+        blocks += counts[i];
+    }
+
+    SoakSample sample;
+    sample.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    sample.residentKb = residentKb;
+    sample.blocks = blocks;
+    sample.p50Us = percentile(counts, blocks, 0.50);
+    sample.p99Us = percentile(counts, blocks, 0.99);
+    sample.maxUs = (double) _maxNanoseconds.exchange(0, std::memory_order_relaxed) / 1000.0;
+
+    sample.counters.generated = counters.generated - _lastCounters.generated;
+    sample.counters.sent = counters.sent - _lastCounters.sent;
+    sample.counters.sendFailures = counters.sendFailures - _lastCounters.sendFailures;
+    sample.counters.dropped = counters.dropped - _lastCounters.dropped;
+    _lastCounters = counters;
+
+    const auto attempts = sample.counters.sent + sample.counters.sendFailures;
+    sample.failureRate = attempts > 0 ? (double) sample.counters.sendFailures / (double) attempts : 0.0;
+
+    if (_summary.numSamples++ == 0)
+        _summary.firstResidentKb = residentKb;
+    _summary.lastResidentKb = residentKb;
+    _summary.peakResidentKb = std::max(_summary.peakResidentKb, residentKb);
+    _summary.worstP99Us = std::max(_summary.worstP99Us, sample.p99Us);
+    _summary.worstMaxUs = std::max(_summary.worstMaxUs, sample.maxUs);
+    _summary.totals.generated += sample.counters.generated;
+    _summary.totals.sent += sample.counters.sent;
+    _summary.totals.sendFailures += sample.counters.sendFailures;
+    _summary.totals.dropped += sample.counters.dropped;
+    return sample;
+}
+
+SoakSummary SoakMonitor::getSummary() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _summary;
+}
+
+void SoakMonitor::writeLine(const SoakSample& sample) {
+    if (_logBytes >= _maxLogBytes) {
+        _log.close();
+        const auto previous = _logPath + ".1";
+        std::remove(previous.c_str());
+        std::rename(_logPath.c_str(), previous.c_str());
+        _log.open(_logPath, std::ios::out | std::ios::trunc);
+        _log << logHeader;
+        _logBytes = std::char_traits<char>::length(logHeader);
+    }
+
+    char line[256];
+    const int length = std::snprintf(line, sizeof(line), "%.1f %llu %llu %.1f %.1f %.1f %llu %llu %llu %.6f %llu\n",
+                                     sample.elapsedSeconds,
+                                     (unsigned long long) sample.residentKb,
+                                     (unsigned long long) sample.blocks,
+                                     sample.p50Us, sample.p99Us, sample.maxUs,
+                                     (unsigned long long) sample.counters.generated,
+                                     (unsigned long long) sample.counters.sent,
+                                     (unsigned long long) sample.counters.sendFailures,
+                                     sample.failureRate,
+                                     (unsigned long long) sample.counters.dropped);
+    if (length > 0) {
+        _log << line << std::flush;
+        _logBytes += (size_t) length;
+    }
+}
+
+} // namespace midisender
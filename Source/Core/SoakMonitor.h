@@ -0,0 +1,134 @@
+//
+//  SoakMonitor.h
+//  MidiSender
+//
+//  Watches a long run for slow degradation. The audio thread records how
+//  long each block took into a lock-free histogram; a background thread
+//  wakes every interval and appends one line to a log:
+//
+//      elapsed_s rss_kb blocks p50_us p99_us max_us generated sent send_failures failure_rate dropped
+//
+//  Block times and counters cover the interval since the previous line; the
+//  resident memory is the current value. When the log grows past its size
+//  limit it is moved to <path>.1 and a new one is started, so at most twice
+//  the limit is kept on disk however long the run.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace midisender
+{
+
+/** Running totals read at every sample, e.g. from OscEngine's statistics. */
+struct SoakCounters {
+    uint64_t generated = 0;
+    uint64_t sent = 0;
+    uint64_t sendFailures = 0;
+    uint64_t dropped = 0;
+};
+
+struct SoakSample {
+    double elapsedSeconds = 0.0;
+    uint64_t residentKb = 0;
+    uint64_t blocks = 0;
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+    SoakCounters counters;      // increase since the previous sample
+    double failureRate = 0.0;   // send failures / send attempts in the interval
+};
+
+/** Extremes over every sample taken since start(). */
+struct SoakSummary {
+    size_t numSamples = 0;
+    uint64_t firstResidentKb = 0;
+    uint64_t lastResidentKb = 0;
+    uint64_t peakResidentKb = 0;
+    double worstP99Us = 0.0;
+    double worstMaxUs = 0.0;
+    SoakCounters totals;
+};
+
+class SoakMonitor {
+public:
+    using CounterSource = std::function<SoakCounters()>;
+
+    SoakMonitor();
+    ~SoakMonitor();
+
+    SoakMonitor(const SoakMonitor&) = delete;
+    SoakMonitor& operator=(const SoakMonitor&) = delete;
+
+    /** Set before start(). */
+    void setCounterSource(CounterSource source) { _source = std::move(source); }
+
+    /** Opens (truncates) the log and starts sampling every intervalMs.
+        Returns false if the log cannot be written. */
+    bool start(const std::string& logPath, int intervalMs, size_t maxLogBytes = 16 * 1024 * 1024);
+
+    /** Logs the interval since the last line, then stops sampling. */
+    void stop();
+    bool isRunning() const { return _thread.joinable(); }
+
+    /** Audio thread. One histogram increment, never blocks. */
+    void recordBlock(std::chrono::nanoseconds duration) {
+        const auto nanoseconds = (uint64_t) std::max<int64_t>(0, duration.count());
+        auto& bucket = _buckets[bucketFor(nanoseconds)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (nanoseconds > _maxNanoseconds.load(std::memory_order_relaxed))
+            _maxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+    }
+
+    /** Measures the interval since the previous sample and adds it to the
+        summary. Called by the sampling thread; public so that tests can
+        sample without waiting for it. */
+    SoakSample takeSample();
+
+    SoakSummary getSummary();
+
+    /** Resident set size of this process, 0 where it cannot be read. */
+    static uint64_t getResidentMemoryKb();
+
+    /** Block times are kept with 8 buckets per power of two, i.e. to within
+        12.5%, from 1 ns up to over an hour. */
+    static constexpr size_t numBuckets = 320;
+    static size_t bucketFor(uint64_t nanoseconds);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+private:
+    void run(int intervalMs);
+    void writeLine(const SoakSample& sample);
+
+    std::array<std::atomic<uint64_t>, numBuckets> _buckets;
+    std::atomic<uint64_t> _maxNanoseconds { 0 };
+
+    std::mutex _lock;   // guards everything below up to the thread
+    CounterSource _source;
+    std::array<uint64_t, numBuckets> _lastBuckets {};
+    SoakCounters _lastCounters;
+    std::chrono::steady_clock::time_point _start;
+    SoakSummary _summary;
+    std::string _logPath;
+    std::ofstream _log;
+    size_t _logBytes = 0;
+    size_t _maxLogBytes = 0;
+
+    std::condition_variable _wakeUp;
+    bool _stopRequested = false;
+    std::thread _thread;
+};
+
+} // namespace midisender
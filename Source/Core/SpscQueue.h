@@ -0,0 +1,66 @@
+//
+//  SpscQueue.h
+//  MidiSender
+//
+//  Bounded single-producer / single-consumer FIFO. push() and pop() never
+//  allocate or lock, so the audio thread can hand events to the sender thread.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace midisender
+{
+
+template <typename T>
+class SpscQueue {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SpscQueue only stores trivially copyable types");
+
+    /** Capacity is rounded up to the next power of two. */
+    explicit SpscQueue(size_t minimumCapacity) {
+        size_t capacity = 2;
+        while (capacity < minimumCapacity)
+            capacity <<= 1;
+        _slots.resize(capacity);
+        _mask = capacity - 1;
+    }
+
+    /** Producer side. Returns false when the queue is full. */
+    bool push(const T& item) {
+        const auto head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) > _mask)
+            return false;
+        _slots[head & _mask] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer side. Returns false when the queue is empty. */
+    bool pop(T& item) {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+            return false;
+        item = _slots[tail & _mask];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+private:
+    std::vector<T> _slots;
+    size_t _mask = 0;
+    alignas(64) std::atomic<size_t> _head { 0 };
+    alignas(64) std::atomic<size_t> _tail { 0 };
+};
+
+} // namespace midisender
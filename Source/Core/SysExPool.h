@@ -0,0 +1,81 @@
+//
+//  SysExPool.h
+//  MidiSender
+//
+//  Preallocated byte ring that carries SysEx payloads from the audio thread
+//  to the sender thread. The audio thread copies each message in once; the
+//  MidiEvent queued alongside records where it landed, and the sender thread
+//  hands that memory straight to the socket before releasing it.
+//
+//  Positions are free-running 32 bit counters. A message never wraps around
+//  the end of the ring: the bytes left at the end are skipped instead, and
+//  reclaimed when the message after them is released.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace midisender
+{
+
+class SysExPool {
+public:
+    /** Capacity is rounded up to the next power of two. */
+    explicit SysExPool(size_t minimumCapacity) {
+        size_t capacity = 256;
+        while (capacity < minimumCapacity)
+            capacity <<= 1;
+        _buffer.resize(capacity);
+    }
+
+    /** Audio thread. Copies the message in and returns its position through
+        `position`, or false if the ring has no room for it right now. */
+    bool write(const uint8_t* data, uint32_t size, uint32_t& position) {
+        const auto capacity = (uint32_t) _buffer.size();
+        if (size == 0 || size > capacity)
+            return false;
+
+        auto start = _head.load(std::memory_order_relaxed);
+        const auto offset = start & (capacity - 1);
+        if (offset + size > capacity)
+            start += capacity - offset;
+
+        if (start + size - _tail.load(std::memory_order_acquire) > capacity)
+            return false;
+
+        std::memcpy(_buffer.data() + (start & (capacity - 1)), data, size);
+        _head.store(start + size, std::memory_order_release);
+        position = start;
+        return true;
+    }
+
+    /** Audio thread. Takes back the message just written at `position`, e.g.
+        when its event could not be queued. */
+    void discard(uint32_t position) {
+        _head.store(position, std::memory_order_relaxed);
+    }
+
+    /** Sender thread. The bytes stay valid until release(). */
+    const uint8_t* getData(uint32_t position) const {
+        return _buffer.data() + (position & (uint32_t(_buffer.size()) - 1));
+    }
+
+    /** Sender thread. Frees this message and everything written before it. */
+    void release(uint32_t position, uint32_t size) {
+        _tail.store(position + size, std::memory_order_release);
+    }
+
+    size_t capacity() const { return _buffer.size(); }
+
+private:
+    std::vector<uint8_t> _buffer;
+    alignas(64) std::atomic<uint32_t> _head { 0 };
+    alignas(64) std::atomic<uint32_t> _tail { 0 };
+};
+
+} // namespace midisender
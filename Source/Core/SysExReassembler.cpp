@@ -0,0 +1,69 @@
+//
+//  SysExReassembler.cpp
+//  MidiSender
+//
+
+#include "SysExReassembler.h"
+
+#include <algorithm>
+
+namespace midisender
+{
+
+SysExReassembler::SysExReassembler(size_t maxPendingMessages, int maxFragments)
+    : _maxPendingMessages(std::max<size_t>(maxPendingMessages, 1)),
+      _maxFragments(maxFragments) {}
+
+bool SysExReassembler::addFragment(const OscMessageView& message, const MessageCallback& callback) {
+    int32_t messageId, index, count;
+    const uint8_t* data;
+    size_t size;
+    if (message.typeTags != "iiib"
+        || ! message.getInt32(0, messageId) || ! message.getInt32(1, index) || ! message.getInt32(2, count)
+        || ! message.getBlob(3, data, size))
+        return false;
+    if (count <= 0 || count > _maxFragments || index < 0 || index >= count)
+        return false;
+
+    // Single datagram messages, the common case, skip the bookkeeping.
+    if (count == 1) {
+        callback(data, size);
+        return true;
+    }
+
+    auto pending = std::find_if(_pending.begin(), _pending.end(), [messageId](const Pending& p) { return p.messageId == messageId; });
+    if (pending == _pending.end()) {
+        if (_pending.size() >= _maxPendingMessages) {
+            _pending.erase(std::min_element(_pending.begin(), _pending.end(), [](const Pending& a, const Pending& b) {
+                return a.startOrder < b.startOrder;
+            }));
+            ++_numDiscarded;
+        }
+        Pending started;
+        started.messageId = messageId;
+        started.startOrder = _nextOrder++;
+        started.fragments.resize((size_t) count);
+        started.received.resize((size_t) count, false);
+        _pending.push_back(std::move(started));
+        pending = _pending.end() - 1;
+    } else if (pending->fragments.size() != (size_t) count) {
+        return false;
+    }
+
+    if (! pending->received[(size_t) index]) {
+        pending->received[(size_t) index] = true;
+        pending->fragments[(size_t) index].assign(data, data + size);
+        ++pending->numReceived;
+    }
+
+    if (pending->numReceived == count) {
+        _message.clear();
+        for (const auto& fragment : pending->fragments)
+            _message.insert(_message.end(), fragment.begin(), fragment.end());
+        _pending.erase(pending);
+        callback(_message.data(), _message.size());
+    }
+    return true;
+}
+
+} // namespace midisender
@@ -0,0 +1,53 @@
+//
+//  SysExReassembler.h
+//  MidiSender
+//
+//  Receiver side of the /<mainId>/sysex fragments written by MidiOscEncoder.
+//  Fragments may arrive in any order and interleaved with other messages;
+//  each message is handed on once all of its fragments are in. Only a few
+//  partial messages are kept: starting one more drops the oldest.
+//
+
+#pragma once
+
+#include "OscPacket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace midisender
+{
+
+class SysExReassembler {
+public:
+    using MessageCallback = std::function<void(const uint8_t* data, size_t size)>;
+
+    explicit SysExReassembler(size_t maxPendingMessages = 4, int maxFragments = 4096);
+
+    /** Takes one /<mainId>/sysex message; the caller matches the address.
+        Returns false if the arguments are not a valid fragment. */
+    bool addFragment(const OscMessageView& message, const MessageCallback& callback);
+
+    size_t getNumPending() const { return _pending.size(); }
+    uint64_t getNumDiscarded() const { return _numDiscarded; }
+
+private:
+    struct Pending {
+        int32_t messageId = 0;
+        int numReceived = 0;
+        uint64_t startOrder = 0;
+        std::vector<std::vector<uint8_t>> fragments;
+        std::vector<bool> received;
+    };
+
+    size_t _maxPendingMessages;
+    int _maxFragments;
+    std::vector<Pending> _pending;
+    std::vector<uint8_t> _message;
+    uint64_t _nextOrder = 0;
+    uint64_t _numDiscarded = 0;
+};
+
+} // namespace midisender
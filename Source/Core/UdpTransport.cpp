@@ -0,0 +1,273 @@
+//
+//  UdpTransport.cpp
+//  MidiSender
+//
+
+#include "UdpTransport.h"
+
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace midisender
+{
+
+namespace
+{
+/** Accepts either a dotted IPv4 address or an interface name such as "eth0". */
+bool resolveInterfaceAddress(const std::string& interface, in_addr& address) {
+    if (inet_pton(AF_INET, interface.c_str(), &address) == 1)
+        return true;
+
+    ifaddrs* interfaces = nullptr;
+    if (getifaddrs(&interfaces) != 0)
+        return false;
+
+    bool found = false;
+    for (auto* entry = interfaces; entry != nullptr && ! found; entry = entry->ifa_next) {
+        if (entry->ifa_addr != nullptr && entry->ifa_addr->sa_family == AF_INET && interface == entry->ifa_name) {
+            address = reinterpret_cast<const sockaddr_in*>(entry->ifa_addr)->sin_addr;
+            found = true;
+        }
+    }
+    freeifaddrs(interfaces);
+    return found;
+}
+
+bool applyMulticastOptions(int fd, int family, const MulticastOptions& options) {
+    const int ttl = options.ttl < 0 ? 0 : (options.ttl > 255 ? 255 : options.ttl);
+    const int loop = options.loopback ? 1 : 0;
+
+    if (family == AF_INET6) {
+        if (! options.interface.empty()) {
+            const unsigned index = if_nametoindex(options.interface.c_str());
+            if (index == 0 || setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_IF, &index, sizeof(index)) != 0)
+                return false;
+        }
+        return setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &ttl, sizeof(ttl)) == 0
+            && setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &loop, sizeof(loop)) == 0;
+    }
+
+    if (! options.interface.empty()) {
+        in_addr local;
+        if (! resolveInterfaceAddress(options.interface, local)
+            || setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &local, sizeof(local)) != 0)
+            return false;
+    }
+
+    const unsigned char ttlByte = (unsigned char) ttl;
+    const unsigned char loopByte = (unsigned char) loop;
+    return setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttlByte, sizeof(ttlByte)) == 0
+        && setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loopByte, sizeof(loopByte)) == 0;
+}
+}
+
+bool isMulticastAddress(const std::string& host) {
+    in_addr address4;
+    if (inet_pton(AF_INET, host.c_str(), &address4) == 1)
+        return (ntohl(address4.s_addr) & 0xf0000000) == 0xe0000000;
+
+    in6_addr address6;
+    if (inet_pton(AF_INET6, host.c_str(), &address6) == 1)
+        return address6.s6_addr[0] == 0xff;
+
+    return false;
+}
+
+//==============================================================================
+UdpSender::~UdpSender() {
+    disconnect();
+}
+
+bool UdpSender::connect(const std::string& host, int port, const MulticastOptions* multicast) {
+    disconnect();
+    if (port < 1 || port > 65535)
+        return false;
+    if (multicast != nullptr && ! isMulticastAddress(host))
+        return false;
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo* result = nullptr;
+    const auto service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0)
+        return false;
+
+    for (auto* info = result; info != nullptr; info = info->ai_next) {
+        const int fd = ::socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd < 0)
+            continue;
+
+        if (multicast != nullptr && ! applyMulticastOptions(fd, info->ai_family, *multicast)) {
+            ::close(fd);
+            continue;
+        }
+
+        // A connected datagram socket lets send() skip the per-packet address lookup.
+        if (::connect(fd, info->ai_addr, info->ai_addrlen) == 0) {
+            _socket = fd;
+            break;
+        }
+        ::close(fd);
+    }
+
+    freeaddrinfo(result);
+    return _socket >= 0;
+}
+
+void UdpSender::disconnect() {
+    if (_socket >= 0) {
+        ::close(_socket);
+        _socket = -1;
+    }
+}
+
+bool UdpSender::send(const uint8_t* data, size_t size) {
+    if (_socket < 0)
+        return false;
+    return ::send(_socket, data, size, 0) == (ssize_t) size;
+}
+
+bool UdpSender::send(const ByteRange* parts, int numParts) {
+    constexpr int maxParts = 8;
+    if (_socket < 0 || numParts <= 0 || numParts > maxParts)
+        return false;
+
+    iovec vectors[maxParts];
+    size_t size = 0;
+    for (int i = 0; i < numParts; ++i) {
+        vectors[i].iov_base = const_cast<void*>(parts[i].data);
+        vectors[i].iov_len = parts[i].size;
+        size += parts[i].size;
+    }
+
+    msghdr message {};
+    message.msg_iov = vectors;
+    message.msg_iovlen = (decltype(message.msg_iovlen)) numParts;
+    return ::sendmsg(_socket, &message, 0) == (ssize_t) size;
+}
+
+int UdpSender::receive(uint8_t* buffer, size_t capacity, int timeoutMs) {
+    if (_socket < 0)
+        return -1;
+
+    pollfd descriptor { _socket, POLLIN, 0 };
+    if (poll(&descriptor, 1, timeoutMs) <= 0)
+        return -1;
+
+    // A connected datagram socket only receives from its peer.
+    const auto received = ::recv(_socket, buffer, capacity, 0);
+    return received < 0 ? -1 : (int) received;
+}
+
+//==============================================================================
+UdpReceiver::~UdpReceiver() {
+    close();
+}
+
+bool UdpReceiver::bind(int port) {
+    close();
+
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return false;
+
+    const int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t) port);
+
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    _port = ntohs(address.sin_port);
+    _socket = fd;
+    return true;
+}
+
+bool UdpReceiver::joinMulticastGroup(const std::string& group, const std::string& interface) {
+    if (_socket < 0)
+        return false;
+
+    ip_mreq request;
+    std::memset(&request, 0, sizeof(request));
+    if (inet_pton(AF_INET, group.c_str(), &request.imr_multiaddr) != 1)
+        return false;
+
+    request.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (! interface.empty() && ! resolveInterfaceAddress(interface, request.imr_interface))
+        return false;
+
+    return setsockopt(_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) == 0;
+}
+
+void UdpReceiver::close() {
+    if (_socket >= 0) {
+        ::close(_socket);
+        _socket = -1;
+    }
+    _port = 0;
+}
+
+int UdpReceiver::receive(uint8_t* buffer, size_t capacity, int timeoutMs) {
+    if (_socket < 0)
+        return -1;
+
+    pollfd descriptor { _socket, POLLIN, 0 };
+    if (poll(&descriptor, 1, timeoutMs) <= 0)
+        return -1;
+
+    const auto received = ::recv(_socket, buffer, capacity, 0);
+    return received < 0 ? -1 : (int) received;
+}
+
+int UdpReceiver::receive(uint8_t* buffer, size_t capacity, int timeoutMs, UdpEndpoint& source) {
+    if (_socket < 0)
+        return -1;
+
+    pollfd descriptor { _socket, POLLIN, 0 };
+    if (poll(&descriptor, 1, timeoutMs) <= 0)
+        return -1;
+
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    const auto received = ::recvfrom(_socket, buffer, capacity, 0, reinterpret_cast<sockaddr*>(&address), &length);
+    if (received < 0)
+        return -1;
+    source.address = ntohl(address.sin_addr.s_addr);
+    source.port = ntohs(address.sin_port);
+    return (int) received;
+}
+
+bool UdpReceiver::sendTo(const UdpEndpoint& destination, const uint8_t* data, size_t size) {
+    if (_socket < 0)
+        return false;
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(destination.address);
+    address.sin_port = htons(destination.port);
+    return ::sendto(_socket, data, size, 0, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == (ssize_t) size;
+}
+
+} // namespace midisender
@@ -0,0 +1,98 @@
+//
+//  UdpTransport.h
+//  MidiSender
+//
+//  Connectionless UDP sender/receiver on plain BSD sockets.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace midisender
+{
+
+/** Outgoing options used when the destination is a multicast group. */
+struct MulticastOptions {
+    std::string interface;   // local IPv4 address or interface name, empty = OS default
+    int ttl = 1;             // 1 keeps packets on the local subnet
+    bool loopback = false;   // also deliver to receivers on this machine
+};
+
+bool isMulticastAddress(const std::string& host);
+
+class UdpSender {
+public:
+    UdpSender() = default;
+    ~UdpSender();
+
+    UdpSender(const UdpSender&) = delete;
+    UdpSender& operator=(const UdpSender&) = delete;
+
+    /** Resolves the target and opens a socket. When multicast options are given
+        the target must be a multicast group and the options are applied to the
+        socket. Not realtime safe. */
+    bool connect(const std::string& host, int port, const MulticastOptions* multicast = nullptr);
+    void disconnect();
+    bool isConnected() const { return _socket >= 0; }
+
+    /** Sends one datagram. Returns false if it could not be handed to the OS. */
+    bool send(const uint8_t* data, size_t size);
+
+    struct ByteRange {
+        const void* data;
+        size_t size;
+    };
+
+    /** Sends one datagram gathered from several buffers, which the OS reads
+        in place instead of them being joined into a packet first. */
+    bool send(const ByteRange* parts, int numParts);
+
+    /** Waits up to timeoutMs for a reply from the connected peer, e.g. a clock
+        pong. Returns its size, or -1 on timeout/error. */
+    int receive(uint8_t* buffer, size_t capacity, int timeoutMs);
+
+private:
+    int _socket = -1;
+};
+
+/** IPv4 address and port of a datagram's sender, in host byte order. */
+struct UdpEndpoint {
+    uint32_t address = 0;
+    uint16_t port = 0;
+};
+
+/** Bound UDP socket, used by the test harness and by the reference receiver. */
+class UdpReceiver {
+public:
+    UdpReceiver() = default;
+    ~UdpReceiver();
+
+    UdpReceiver(const UdpReceiver&) = delete;
+    UdpReceiver& operator=(const UdpReceiver&) = delete;
+
+    /** Binds to the given port on all interfaces; port 0 picks a free one. */
+    bool bind(int port);
+
+    /** Subscribes to an IPv4 group on the given local interface (empty = any). */
+    bool joinMulticastGroup(const std::string& group, const std::string& interface = {});
+    void close();
+    int getBoundPort() const { return _port; }
+
+    /** Waits up to timeoutMs for a datagram. Returns its size, or -1 on timeout/error. */
+    int receive(uint8_t* buffer, size_t capacity, int timeoutMs);
+
+    /** Same as receive(), also reporting where the datagram came from. */
+    int receive(uint8_t* buffer, size_t capacity, int timeoutMs, UdpEndpoint& source);
+
+    /** Replies to a previously received datagram's sender. */
+    bool sendTo(const UdpEndpoint& destination, const uint8_t* data, size_t size);
+
+private:
+    int _socket = -1;
+    int _port = 0;
+};
+
+} // namespace midisender
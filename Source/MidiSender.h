@@ -24,22 +24,25 @@
 
 class OscSenderAudioProcessor  : public AudioProcessor,
                                  public OscHostListener,
-                                 private juce::AudioProcessorValueTreeState::Listener
+                                 private juce::AudioProcessorValueTreeState::Listener,
+                                 private juce::Timer
 {
 public:
     OscSenderAudioProcessor()
     : AudioProcessor (getBusesProperties()),
-    valueTreeState (*this, nullptr, "state", {
-        std::make_unique<juce::AudioParameterInt> (IDs::oscPort,
-                                                   IDs::oscPortName,
-                                                   MIN_OSC_PORT,
-                                                   MAX_OSC_PORT,
-                                                   DEFAULT_OSC_PORT)
-        
-    })
+    valueTreeState (*this, nullptr, "state", createParameterLayout())
     {
-        valueTreeState.state.addChild ({ "uiState", { { "width",  400 }, { "height", timecodeHeight + midiKeyboardHeight + oscSectionHeight + vertMargin } }, {} }, -1, nullptr);
+        valueTreeState.state.addChild ({ "uiState", { { "width",  400 }, { "height", timecodeHeight + midiKeyboardHeight + oscSectionHeight + multicastSectionHeight + syncSectionHeight + paramSectionHeight + routingSectionHeight + vertMargin } }, {} }, -1, nullptr);
         valueTreeState.addParameterListener(IDs::oscPort, this);
+        
+        for (int i = 0; i < NUM_MACRO_PARAMETERS; ++i)
+            macroValues[(size_t) i] = valueTreeState.getRawParameterValue (IDs::macro + juce::String (i + 1));
+        
+        for (auto* id : { &IDs::transpose, &IDs::lowKey, &IDs::highKey, &IDs::velocityCurve, &IDs::outputChannel })
+            valueTreeState.addParameterListener(*id, this);
+        updateMidiTransform();
+        startSoakTest();
+        startTimerHz (30);
     }
 
     ~OscSenderAudioProcessor() override = default;
@@ -66,12 +69,33 @@ public:
         return true;
     }
     
-    void parameterChanged (const juce::String& param, float value) override {
+    void parameterChanged (const juce::String& param, float) override {
+        // May arrive on the audio thread during automation: reconnecting and
+        // rebuilding the transform tables are left to the timer.
         if (param == IDs::oscPort) {
-            oscPortHasChanged(value);
+            oscPortIsDirty = true;
+        } else {
+            midiTransformHasChanged = true;
         }
     }
     
+    void timerCallback() override {
+        if (oscPortIsDirty.exchange(false))
+            oscPortHasChanged((int) *valueTreeState.getRawParameterValue(IDs::oscPort));
+        if (midiTransformHasChanged.exchange(false))
+            updateMidiTransform();
+    }
+    
+    void updateMidiTransform() {
+        midisender::MidiTransformSettings settings;
+        settings.transpose = (int) *valueTreeState.getRawParameterValue(IDs::transpose);
+        settings.lowKey = (int) *valueTreeState.getRawParameterValue(IDs::lowKey);
+        settings.highKey = (int) *valueTreeState.getRawParameterValue(IDs::highKey);
+        settings.velocityCurve = (midisender::VelocityCurve) (int) *valueTreeState.getRawParameterValue(IDs::velocityCurve);
+        settings.outputChannel = (int) *valueTreeState.getRawParameterValue(IDs::outputChannel);
+        midiTransform.setSettings(settings);
+    }
+    
     void oscMainIDHasChanged (juce::String newOscMainID) override {
         oscManager.setMaindId(newOscMainID);
     }
@@ -80,17 +104,64 @@ public:
         oscManager.setOscHost(newOscHostAdress);
     }
 
+    void oscMulticastHasChanged (bool enabled, juce::String interfaceName, int ttl, bool loopback) override {
+        oscManager.setMulticast(enabled, interfaceName, ttl, loopback);
+    }
+
+    void oscSyncHasChanged (int syncPort, int snapshotIntervalMs) override {
+        oscManager.setSync(syncPort, snapshotIntervalMs);
+    }
+
+    juce::String oscRoutingHasChanged (juce::String rulesText) override {
+        return oscManager.setRoutingRules(rulesText);
+    }
+
+    void oscOfflineModeHasChanged (midisender::OfflineMode mode) override {
+        oscManager.setOfflineMode(mode);
+    }
+
+    void oscParameterStreamHasChanged (float maxRateHz, float smoothingMs) override {
+        oscManager.setParameterStream(maxRateHz, smoothingMs);
+    }
+
+    void oscClockSyncHasChanged (int intervalMs) override {
+        oscManager.setClockSync(intervalMs);
+    }
+
     void oscPortHasChanged(int newOscPort) {
         oscManager.setOscPort(newOscPort);
     }
 
+    // Applies the OSC settings saved in the state straight to the manager, so a
+    // restored session sends correctly even if the editor is never opened.
+    void applyOscState() {
+        auto oscNode = valueTreeState.state.getOrCreateChildWithName (IDs::oscData, nullptr);
+        oscManager.setMaindId (oscNode.getProperty (IDs::mainId, DEFAULT_OSC_MAIN_ID).toString());
+        oscManager.setOscHost (oscNode.getProperty (IDs::hostAddress, DEFAULT_OSC_HOST).toString());
+        oscPortHasChanged ((int) *valueTreeState.getRawParameterValue (IDs::oscPort));
+        oscManager.setMulticast (oscNode.getProperty (IDs::multicast, false),
+                                 oscNode.getProperty (IDs::multicastInterface, juce::String()).toString(),
+                                 oscNode.getProperty (IDs::multicastTtl, DEFAULT_MULTICAST_TTL),
+                                 oscNode.getProperty (IDs::multicastLoopback, false));
+        oscManager.setSync (oscNode.getProperty (IDs::syncPort, DEFAULT_SYNC_PORT),
+                            oscNode.getProperty (IDs::snapshotInterval, DEFAULT_SNAPSHOT_INTERVAL_MS));
+        oscManager.setRoutingRules (oscNode.getProperty (IDs::routing, juce::String()).toString());
+        oscManager.setOfflineMode ((midisender::OfflineMode) (int) oscNode.getProperty (IDs::offlineMode, (int) DEFAULT_OFFLINE_MODE));
+        oscManager.setParameterStream (oscNode.getProperty (IDs::paramRate, DEFAULT_PARAM_RATE_HZ),
+                                       oscNode.getProperty (IDs::paramSmoothing, DEFAULT_PARAM_SMOOTHING_MS));
+        oscManager.setClockSync (oscNode.getProperty (IDs::clockSync, DEFAULT_CLOCK_SYNC_INTERVAL_MS));
+    }
+
     void prepareToPlay (double newSampleRate, int /*samplesPerBlock*/) override {
         keyboardState.reset();
+        oscManager.resetNoteState();
+        midiTransform.reset();
         reset();
     }
 
     void releaseResources() override {
         keyboardState.reset();
+        oscManager.resetNoteState();
     }
 
     void reset() override {}
@@ -113,7 +184,9 @@ public:
 
     AudioProcessorEditor* createEditor() override
     {
-        editor = new MidiSenderEditor (*this, valueTreeState, keyboardState);
+        // The host owns the editor and may delete it at any time: getActiveEditor()
+        // is the only safe way back to it.
+        auto* editor = new MidiSenderEditor (*this, valueTreeState, keyboardState);
         editor->addOscListener(this);
         return editor;
     }
@@ -145,9 +218,10 @@ public:
         // method.
         if (auto xmlState = getXmlFromBinary (data, sizeInBytes)) {
             valueTreeState.replaceState (ValueTree::fromXml (*xmlState));
-            editor->updateOscLabelsTexts(true);
+            applyOscState();
+            if (auto* editor = dynamic_cast<MidiSenderEditor*> (getActiveEditor()))
+                editor->updateOscLabelsTexts(false);
         }
-            
     }
     
     //==============================================================================
@@ -158,27 +232,120 @@ public:
     OscManager oscManager;
 
 private:
-    MidiSenderEditor* editor;
+    midisender::MidiTransformStage midiTransform;
+    std::atomic<bool> midiTransformHasChanged { false };
+    std::atomic<bool> oscPortIsDirty { false };
+    std::array<std::atomic<float>*, NUM_MACRO_PARAMETERS> macroValues {};
+    
+    // Soak testing is set up once in the constructor, before any block is processed
+    midisender::LoadGenerator loadGenerator;
+    midisender::SoakMonitor soakMonitor;
+    midisender::BlockProcessor blockProcessor { oscManager.getEngine(), midiTransform };
+    
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout() {
+        juce::AudioProcessorValueTreeState::ParameterLayout layout;
+        layout.add (std::make_unique<juce::AudioParameterInt> (IDs::oscPort,
+                                                               IDs::oscPortName,
+                                                               MIN_OSC_PORT,
+                                                               MAX_OSC_PORT,
+                                                               DEFAULT_OSC_PORT));
+        layout.add (std::make_unique<juce::AudioParameterInt> (IDs::transpose, IDs::transposeName, -48, 48, 0));
+        layout.add (std::make_unique<juce::AudioParameterInt> (IDs::lowKey, IDs::lowKeyName, 0, 127, 0));
+        layout.add (std::make_unique<juce::AudioParameterInt> (IDs::highKey, IDs::highKeyName, 0, 127, 127));
+        layout.add (std::make_unique<juce::AudioParameterChoice> (IDs::velocityCurve,
+                                                                  IDs::velocityCurveName,
+                                                                  juce::StringArray { "Linear", "Soft", "Hard", "Fixed" },
+                                                                  (int) midisender::VelocityCurve::linear));
+        layout.add (std::make_unique<juce::AudioParameterInt> (IDs::outputChannel, IDs::outputChannelName, 0, 16, 0));
+        
+        // Streamed as /<mainId>/param/macro<n>
+        for (int i = 1; i <= NUM_MACRO_PARAMETERS; ++i)
+            layout.add (std::make_unique<juce::AudioParameterFloat> (IDs::macro + juce::String (i),
+                                                                     IDs::macroName + juce::String (i),
+                                                                     0.0f, 1.0f, 0.0f));
+        return layout;
+    }
+    
+    // MIDISENDER_SOAK="rate=500 chord=4 ..." adds synthetic MIDI to every block and
+    // logs memory, block times and send failures, see "Soak testing" in the README.
+    void startSoakTest() {
+        const auto loadText = juce::SystemStats::getEnvironmentVariable ("MIDISENDER_SOAK", {});
+        if (loadText.isEmpty())
+            return;
+        
+        midisender::LoadSettings settings;
+        std::string error;
+        if (! midisender::parseLoadSettings (loadText.toStdString(), settings, error)) {
+            juce::Logger::outputDebugString ("Error: invalid MIDISENDER_SOAK setting, " + juce::String (error));
+            return;
+        }
+        loadGenerator.setSettings (settings);
+        soakMonitor.setCounterSource ([this] {
+            auto counters = oscManager.getCounters();
+            counters.generated = loadGenerator.getNumGenerated();
+            return counters;
+        });
+        
+        const auto defaultLog = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                                    .getChildFile ("MidiSender").getChildFile ("soak.log").getFullPathName();
+        const auto logPath = juce::SystemStats::getEnvironmentVariable ("MIDISENDER_SOAK_LOG", defaultLog);
+        const auto intervalMs = juce::SystemStats::getEnvironmentVariable ("MIDISENDER_SOAK_INTERVAL_MS", "10000").getIntValue();
+        if (soakMonitor.start (logPath.toStdString(), intervalMs))
+            blockProcessor.setSoakTest (&loadGenerator, &soakMonitor);
+        else
+            juce::Logger::outputDebugString ("Error: could not write the soak log " + logPath);
+    }
 
     template <typename FloatType>
     void process (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages) {
+        MIDISENDER_REALTIME_SCOPE;
+        midisender::BlockContext context;
+        context.isNonRealtime = isNonRealtime();
+        context.sampleRate = getSampleRate() > 0 ? getSampleRate() : 44100.0;
+        if (auto* playHead = getPlayHead()) {
+           #if JUCE_MAJOR_VERSION >= 7
+            // getCurrentPosition() is deprecated from JUCE 7, and either value may be missing
+            if (const auto position = playHead->getPosition())
+                if (const auto timeInSeconds = position->getTimeInSeconds())
+                    context.timeInSeconds = *timeInSeconds;
+           #else
+            AudioPlayHead::CurrentPositionInfo position;
+            if (playHead->getCurrentPosition (position))
+                context.timeInSeconds = position.timeInSeconds;
+           #endif
+        }
+        blockProcessor.beginBlock (context);
+        
         auto numSamples = buffer.getNumSamples();
         for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
             buffer.clear (i, 0, numSamples);
-        keyboardState.processNextMidiBuffer (midiMessages, 0, numSamples, true);
-        
-        // SEND OSC
-        for (const auto metadata : midiMessages) {
-            auto message = metadata.getMessage();
-            
-            const auto timeStamp = metadata.samplePosition;
-            int channel = message.getChannel();
-            int number = message.getNoteNumber();
-            float velocityFloat = message.getFloatVelocity();
-            bool isNoteOn = message.isNoteOn();
-            
-            oscManager.sendNoteBundle(number, velocityFloat, channel, isNoteOn, timeStamp);
+        {
+            // Known violation, exempted rather than fixed: MidiKeyboardState takes a
+            // CriticalSection shared with the on-screen keyboard on the message thread.
+            MIDISENDER_NON_REALTIME_SCOPE;
+            keyboardState.processNextMidiBuffer (midiMessages, 0, numSamples, true);
         }
+        
+        for (int i = 0; i < NUM_MACRO_PARAMETERS; ++i)
+            blockProcessor.setParameterValue (i, macroValues[(size_t) i]->load (std::memory_order_relaxed));
+        
+        // The forwarded MIDI and the OSC stream both see the transformed events.
+        // Short messages are rewritten where they sit in the buffer, which is safe because:
+        // - MidiBuffer (JUCE 6 to 8) keeps every event inline in one byte array as
+        //   [int32 sample position][uint16 size][message bytes], and the iterator's
+        //   MidiMessageMetadata::data points at those bytes rather than at a copy;
+        // - BlockProcessor::processMessage() only rewrites the status and data bytes of a
+        //   channel message (at most 3) and never changes its size, so the layout holds;
+        // - the host hands the buffer to process() alone, nothing reads it meanwhile.
+        // Building a second buffer with addEvent() would allocate on the audio thread.
+        static_assert (JUCE_MAJOR_VERSION >= 6 && JUCE_MAJOR_VERSION <= 8,
+                       "check that MidiBuffer still iterates over its own storage");
+        for (const auto metadata : midiMessages)
+            blockProcessor.processMessage (const_cast<uint8*> (metadata.data), metadata.numBytes, metadata.samplePosition);
+        
+        // Synthetic soak events only take the OSC path; the host's MidiBuffer is left
+        // alone since adding to it could reallocate.
+        blockProcessor.endBlock (numSamples);
     }
 
     static BusesProperties getBusesProperties()
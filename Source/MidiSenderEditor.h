@@ -14,10 +14,33 @@ namespace IDs
 {
 static juce::String oscPort  { "oscPort" };
 static juce::String oscPortName  { "Osc Port" };
+static juce::String transpose          { "transpose" };
+static juce::String transposeName      { "Transpose" };
+static juce::String lowKey             { "lowKey" };
+static juce::String lowKeyName         { "Lowest Key" };
+static juce::String highKey            { "highKey" };
+static juce::String highKeyName        { "Highest Key" };
+static juce::String velocityCurve      { "velocityCurve" };
+static juce::String velocityCurveName  { "Velocity Curve" };
+static juce::String outputChannel      { "outputChannel" };
+static juce::String outputChannelName  { "Output Channel" };
+static juce::String macro              { "macro" };
+static juce::String macroName          { "Macro " };
 
 static juce::Identifier oscData     { "OSC" };
 static juce::Identifier hostAddress { "host" };
 static juce::Identifier mainId      { "main" };
+static juce::Identifier multicast          { "multicast" };
+static juce::Identifier multicastInterface { "multicastInterface" };
+static juce::Identifier multicastTtl       { "multicastTtl" };
+static juce::Identifier multicastLoopback  { "multicastLoopback" };
+static juce::Identifier syncPort           { "syncPort" };
+static juce::Identifier snapshotInterval   { "snapshotInterval" };
+static juce::Identifier routing            { "routing" };
+static juce::Identifier offlineMode        { "offlineMode" };
+static juce::Identifier paramRate          { "paramRate" };
+static juce::Identifier paramSmoothing     { "paramSmoothing" };
+static juce::Identifier clockSync          { "clockSync" };
 }
 
 enum {
@@ -27,6 +50,18 @@ enum {
     portSliderWidth = 100,
     maindIdLabelWidth = 100,
     hostLabelWidth = 200,
+    multicastSectionHeight = 30,
+    multicastToggleWidth = 100,
+    interfaceLabelWidth = 150,
+    ttlSliderWidth = 100,
+    loopbackToggleWidth = 70,
+    syncSectionHeight = 30,
+    syncSliderWidth = 130,
+    routingSectionHeight = 80,
+    offlineModeBoxWidth = 110,
+    paramSectionHeight = 30,
+    paramSliderWidth = 130,
+    clockSyncSliderWidth = 110,
     vertMargin = 10
 };
 
@@ -65,10 +100,88 @@ public:
         portSlider.setSliderStyle(juce::Slider::IncDecButtons);
         portAttachment.reset (new SliderAttachment (valueTreeState, IDs::oscPort, portSlider));
         
+        addAndMakeVisible (multicastToggle);
+        multicastToggle.setButtonText ("Multicast");
+        multicastToggle.onClick = [this] {
+            // Start from a usable group rather than joining a unicast host
+            if (multicastToggle.getToggleState() && ! midisender::isMulticastAddress (hostLabel.getText().trim().toStdString()))
+                hostLabel.setText (DEFAULT_MULTICAST_GROUP, juce::sendNotificationSync);
+            setOscMulticast();
+        };
+        
+        addAndMakeVisible (interfaceLabel);
+        interfaceLabel.setComponentID("interfaceLabel");
+        interfaceLabel.setEditable(true);
+        interfaceLabel.setTooltip ("Outgoing interface address or name, empty for the system default");
+        interfaceLabel.setColour (juce::Label::textColourId, juce::Colours::lightgrey);
+        interfaceLabel.setJustificationType (juce::Justification::centredRight);
+        interfaceLabel.addListener(this);
+        
+        addAndMakeVisible (ttlSlider);
+        ttlSlider.setSliderStyle(juce::Slider::IncDecButtons);
+        ttlSlider.setRange (0, MAX_MULTICAST_TTL, 1);
+        ttlSlider.setTooltip ("Multicast TTL");
+        ttlSlider.onValueChange = [this] { setOscMulticast(); };
+        
+        addAndMakeVisible (loopbackToggle);
+        loopbackToggle.setButtonText ("Loop");
+        loopbackToggle.onClick = [this] { setOscMulticast(); };
+        
+        addAndMakeVisible (syncPortSlider);
+        syncPortSlider.setSliderStyle(juce::Slider::IncDecButtons);
+        syncPortSlider.setRange (0, MAX_OSC_PORT, 1);
+        syncPortSlider.setTextValueSuffix (" sync");
+        syncPortSlider.setTooltip ("Port listening for /<mainId>/sync queries, 0 = off");
+        syncPortSlider.onValueChange = [this] { setOscSync(); };
+        
+        addAndMakeVisible (snapshotIntervalSlider);
+        snapshotIntervalSlider.setSliderStyle(juce::Slider::IncDecButtons);
+        snapshotIntervalSlider.setRange (0, MAX_SNAPSHOT_INTERVAL_MS, 100);
+        snapshotIntervalSlider.setTextValueSuffix (" ms");
+        snapshotIntervalSlider.setTooltip ("Period of the held-note snapshots, 0 = only on request");
+        snapshotIntervalSlider.onValueChange = [this] { setOscSync(); };
+        
+        addAndMakeVisible (offlineModeBox);
+        // Item IDs are the OfflineMode values + 1
+        offlineModeBox.addItem ("Bounce: send", (int) midisender::OfflineMode::sendImmediately + 1);
+        offlineModeBox.addItem ("Bounce: mute", (int) midisender::OfflineMode::suppress + 1);
+        offlineModeBox.addItem ("Bounce: pace", (int) midisender::OfflineMode::paceToWallClock + 1);
+        offlineModeBox.addItem ("Bounce: file", (int) midisender::OfflineMode::writeToFile + 1);
+        offlineModeBox.setTooltip ("What to send while the host renders offline. File logs go to Documents/MidiSender");
+        offlineModeBox.onChange = [this] { setOscOfflineMode(); };
+        
+        addAndMakeVisible (paramRateSlider);
+        paramRateSlider.setSliderStyle(juce::Slider::IncDecButtons);
+        paramRateSlider.setRange (0, MAX_PARAM_RATE_HZ, 1);
+        paramRateSlider.setTextValueSuffix (" Hz");
+        paramRateSlider.setTooltip ("Maximum send rate of each macro parameter, 0 = every change");
+        paramRateSlider.onValueChange = [this] { setOscParameterStream(); };
+        
+        addAndMakeVisible (paramSmoothingSlider);
+        paramSmoothingSlider.setSliderStyle(juce::Slider::IncDecButtons);
+        paramSmoothingSlider.setRange (0, MAX_PARAM_SMOOTHING_MS, 10);
+        paramSmoothingSlider.setTextValueSuffix (" ms");
+        paramSmoothingSlider.setTooltip ("Smoothing time of the macro parameters, 0 = off");
+        paramSmoothingSlider.onValueChange = [this] { setOscParameterStream(); };
+        
+        addAndMakeVisible (clockSyncSlider);
+        clockSyncSlider.setSliderStyle(juce::Slider::IncDecButtons);
+        clockSyncSlider.setRange (0, MAX_CLOCK_SYNC_INTERVAL_MS, 100);
+        clockSyncSlider.setTextValueSuffix (" ms clk");
+        clockSyncSlider.setTooltip ("Clock ping period, 0 = off. Only paced bounces use it, so pings are only sent in pace mode");
+        clockSyncSlider.onValueChange = [this] { setOscClockSync(); };
+        
+        addAndMakeVisible (routingEditor);
+        routingEditor.setMultiLine (true);
+        routingEditor.setReturnKeyStartsNewLine (true);
+        routingEditor.setTextToShowWhenEmpty ("routing: <channel|*> <low>-<high> <notes|other|all>[,...] <host:port|host|:port|*> <mainId|*>",
+                                              juce::Colours::grey);
+        routingEditor.onFocusLost = [this] { setOscRouting(); };
+        
         updateOscLabelsTexts(false);
         
         setResizeLimits (400,
-                         timecodeHeight + midiKeyboardHeight + oscSectionHeight + vertMargin,
+                         timecodeHeight + midiKeyboardHeight + oscSectionHeight + multicastSectionHeight + syncSectionHeight + paramSectionHeight + routingSectionHeight + vertMargin,
                          1024,
                          700);
         setResizable (true, processor.wrapperType != juce::AudioPluginInstance::wrapperType_AudioUnitv3);
@@ -109,6 +222,58 @@ public:
                              yPos,
                              hostLabelWidth,
                              oscSectionHeight);
+        
+        yPos -= multicastSectionHeight;
+        multicastToggle.setBounds (spacing,
+                                   yPos,
+                                   multicastToggleWidth,
+                                   multicastSectionHeight);
+        loopbackToggle.setBounds (getWidth() - loopbackToggleWidth - spacing,
+                                  yPos,
+                                  loopbackToggleWidth,
+                                  multicastSectionHeight);
+        ttlSlider.setBounds (getWidth() - loopbackToggleWidth - ttlSliderWidth - spacing*2,
+                             yPos,
+                             ttlSliderWidth,
+                             multicastSectionHeight);
+        interfaceLabel.setBounds (getWidth() - loopbackToggleWidth - ttlSliderWidth - interfaceLabelWidth - spacing*3,
+                                  yPos,
+                                  interfaceLabelWidth,
+                                  multicastSectionHeight);
+        
+        yPos -= paramSectionHeight;
+        paramSmoothingSlider.setBounds (getWidth() - paramSliderWidth - spacing,
+                                        yPos,
+                                        paramSliderWidth,
+                                        paramSectionHeight);
+        paramRateSlider.setBounds (getWidth() - paramSliderWidth*2 - spacing*2,
+                                   yPos,
+                                   paramSliderWidth,
+                                   paramSectionHeight);
+        clockSyncSlider.setBounds (spacing,
+                                   yPos,
+                                   clockSyncSliderWidth,
+                                   paramSectionHeight);
+        
+        yPos -= routingSectionHeight;
+        routingEditor.setBounds (spacing,
+                                 yPos,
+                                 getWidth() - spacing*2,
+                                 routingSectionHeight);
+        
+        yPos -= syncSectionHeight;
+        snapshotIntervalSlider.setBounds (getWidth() - syncSliderWidth - spacing,
+                                          yPos,
+                                          syncSliderWidth,
+                                          syncSectionHeight);
+        syncPortSlider.setBounds (getWidth() - syncSliderWidth*2 - spacing*2,
+                                  yPos,
+                                  syncSliderWidth,
+                                  syncSectionHeight);
+        offlineModeBox.setBounds (spacing,
+                                  yPos,
+                                  offlineModeBoxWidth,
+                                  syncSectionHeight);
 
         lastUIWidth  = getWidth();
         lastUIHeight = getHeight();
@@ -123,6 +288,8 @@ public:
             setOscIPAdress(labelThatHasChanged->getText());
         } else if (labelThatHasChanged->getComponentID() == "mainIDLabel") {
             setOscMainID(labelThatHasChanged->getText());
+        } else if (labelThatHasChanged->getComponentID() == "interfaceLabel") {
+            setOscMulticast();
         }
     }
     
@@ -140,6 +307,32 @@ public:
         auto doSend = sendNotification ? juce::sendNotification : juce::dontSendNotification;
         mainIDLabel.setText (mainId, doSend);
         hostLabel.setText (hostAddress, doSend);
+        
+        auto oscNode = valueTreeState.state.getOrCreateChildWithName (IDs::oscData, nullptr);
+        multicastToggle.setToggleState (oscNode.getProperty (IDs::multicast, false), juce::dontSendNotification);
+        interfaceLabel.setText (oscNode.getProperty (IDs::multicastInterface, juce::String()), juce::dontSendNotification);
+        ttlSlider.setValue (oscNode.getProperty (IDs::multicastTtl, DEFAULT_MULTICAST_TTL), juce::dontSendNotification);
+        loopbackToggle.setToggleState (oscNode.getProperty (IDs::multicastLoopback, false), juce::dontSendNotification);
+        
+        syncPortSlider.setValue (oscNode.getProperty (IDs::syncPort, DEFAULT_SYNC_PORT), juce::dontSendNotification);
+        snapshotIntervalSlider.setValue (oscNode.getProperty (IDs::snapshotInterval, DEFAULT_SNAPSHOT_INTERVAL_MS), juce::dontSendNotification);
+        
+        routingEditor.setText (oscNode.getProperty (IDs::routing, juce::String()), false);
+        offlineModeBox.setSelectedId ((int) oscNode.getProperty (IDs::offlineMode, (int) DEFAULT_OFFLINE_MODE) + 1,
+                                      juce::dontSendNotification);
+        
+        paramRateSlider.setValue (oscNode.getProperty (IDs::paramRate, DEFAULT_PARAM_RATE_HZ), juce::dontSendNotification);
+        paramSmoothingSlider.setValue (oscNode.getProperty (IDs::paramSmoothing, DEFAULT_PARAM_SMOOTHING_MS), juce::dontSendNotification);
+        clockSyncSlider.setValue (oscNode.getProperty (IDs::clockSync, DEFAULT_CLOCK_SYNC_INTERVAL_MS), juce::dontSendNotification);
+        
+        if (sendNotification) {
+            setOscMulticast();
+            setOscSync();
+            setOscRouting();
+            setOscOfflineMode();
+            setOscParameterStream();
+            setOscClockSync();
+        }
     }
 
 private:
@@ -154,7 +347,22 @@ private:
     juce::Slider portSlider;
     std::unique_ptr<SliderAttachment> portAttachment;
     
-    OscHostListener* oscListener;
+    juce::ToggleButton multicastToggle;
+    juce::Label interfaceLabel;
+    juce::Slider ttlSlider;
+    juce::ToggleButton loopbackToggle;
+    
+    juce::Slider syncPortSlider;
+    juce::Slider snapshotIntervalSlider;
+    
+    juce::TextEditor routingEditor;
+    juce::ComboBox offlineModeBox;
+    
+    juce::Slider paramRateSlider;
+    juce::Slider paramSmoothingSlider;
+    juce::Slider clockSyncSlider;
+    
+    OscHostListener* oscListener = nullptr;
     
     bool getLastHostAddress(juce::String& address) {
         auto oscNode = valueTreeState.state.getOrCreateChildWithName (IDs::oscData, nullptr);
@@ -198,6 +406,81 @@ private:
         }
     }
     
+    void setOscMulticast() {
+        const bool enabled = multicastToggle.getToggleState();
+        const auto interfaceName = interfaceLabel.getText().trim();
+        const int ttl = (int) ttlSlider.getValue();
+        const bool loopback = loopbackToggle.getToggleState();
+        
+        if (oscListener != nullptr) {
+            oscListener->oscMulticastHasChanged(enabled, interfaceName, ttl, loopback);
+            auto oscNode = valueTreeState.state.getOrCreateChildWithName (IDs::oscData, nullptr);
+            oscNode.setProperty (IDs::multicast, enabled, nullptr);
+            oscNode.setProperty (IDs::multicastInterface, interfaceName, nullptr);
+            oscNode.setProperty (IDs::multicastTtl, ttl, nullptr);
+            oscNode.setProperty (IDs::multicastLoopback, loopback, nullptr);
+        }
+    }
+    
+    void setOscSync() {
+        const int syncPort = (int) syncPortSlider.getValue();
+        const int snapshotInterval = (int) snapshotIntervalSlider.getValue();
+        
+        if (oscListener != nullptr) {
+            oscListener->oscSyncHasChanged(syncPort, snapshotInterval);
+            auto oscNode = valueTreeState.state.getOrCreateChildWithName (IDs::oscData, nullptr);
+            oscNode.setProperty (IDs::syncPort, syncPort, nullptr);
+            oscNode.setProperty (IDs::snapshotInterval, snapshotInterval, nullptr);
+        }
+    }
+    
+    void setOscRouting() {
+        const auto rulesText = routingEditor.getText();
+        
+        if (oscListener != nullptr) {
+            const auto error = oscListener->oscRoutingHasChanged(rulesText);
+            routingEditor.setColour (juce::TextEditor::outlineColourId, error.isEmpty() ? juce::Colours::transparentBlack
+                                                                                         : juce::Colours::red);
+            routingEditor.setTooltip (error);
+            routingEditor.repaint();
+            
+            auto oscNode = valueTreeState.state.getOrCreateChildWithName (IDs::oscData, nullptr);
+            oscNode.setProperty (IDs::routing, rulesText, nullptr);
+        }
+    }
+    
+    void setOscOfflineMode() {
+        const int mode = offlineModeBox.getSelectedId() - 1;
+        
+        if (oscListener != nullptr && mode >= 0) {
+            oscListener->oscOfflineModeHasChanged((midisender::OfflineMode) mode);
+            auto oscNode = valueTreeState.state.getOrCreateChildWithName (IDs::oscData, nullptr);
+            oscNode.setProperty (IDs::offlineMode, mode, nullptr);
+        }
+    }
+    
+    void setOscParameterStream() {
+        const auto maxRateHz = (float) paramRateSlider.getValue();
+        const auto smoothingMs = (float) paramSmoothingSlider.getValue();
+        
+        if (oscListener != nullptr) {
+            oscListener->oscParameterStreamHasChanged(maxRateHz, smoothingMs);
+            auto oscNode = valueTreeState.state.getOrCreateChildWithName (IDs::oscData, nullptr);
+            oscNode.setProperty (IDs::paramRate, maxRateHz, nullptr);
+            oscNode.setProperty (IDs::paramSmoothing, smoothingMs, nullptr);
+        }
+    }
+    
+    void setOscClockSync() {
+        const int intervalMs = (int) clockSyncSlider.getValue();
+        
+        if (oscListener != nullptr) {
+            oscListener->oscClockSyncHasChanged(intervalMs);
+            auto oscNode = valueTreeState.state.getOrCreateChildWithName (IDs::oscData, nullptr);
+            oscNode.setProperty (IDs::clockSync, intervalMs, nullptr);
+        }
+    }
+    
     // called when the stored window size changes
     void valueChanged (Value&) override {
         setSize (lastUIWidth.getValue(), lastUIHeight.getValue());
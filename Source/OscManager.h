@@ -1,11 +1,10 @@
 
 #pragma once
 
-#define DEFAULT_OSC_HOST "127.0.0.1"
-#define DEFAULT_OSC_PORT 9001
-#define DEFAULT_OSC_MAIN_ID "trackId"
-#define MIN_OSC_PORT 1
-#define MAX_OSC_PORT 65535
+#include "Core/BlockProcessor.h"
+#include "Core/OscEngine.h"
+#include "Core/RealtimeCheck.h"
+#include "Core/SoakMonitor.h"
 
 class OscManager {
 public:
@@ -14,22 +13,28 @@ public:
         _oscHost = DEFAULT_OSC_HOST;
         _oscPort = DEFAULT_OSC_PORT;
         _mainID = DEFAULT_OSC_MAIN_ID;
-        _isConnected = false;
         connect();
+        
+        auto logFolder = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory).getChildFile ("MidiSender");
+        logFolder.createDirectory();
+        engine.setOfflineLogFolder(logFolder.getFullPathName().toStdString());
+        
+        setParameterStream(DEFAULT_PARAM_RATE_HZ, DEFAULT_PARAM_SMOOTHING_MS);
     }
     
     void setMaindId(juce::String mainId) {
         _mainID = mainId;
+        engine.setMainId(mainId.toStdString());
     }
     
     void setOscPort(int port) {
         _oscPort = port;
-        connect();
+        engine.setPort(port);
     }
     
     void setOscHost(juce::String hostAdress) {
         _oscHost = hostAdress;
-        connect();
+        engine.setHost(hostAdress.toStdString());
     }
     
     void connect() {
@@ -37,57 +42,84 @@ public:
     }
     
     void connect(const juce::String& targetHostName, int targetPortNumber) {
-        _isConnected = false;
-        oscSender.disconnect();
-        
-        _isConnected = oscSender.connect (targetHostName, targetPortNumber);
-        if (! _isConnected) {
-            juce::Logger::outputDebugString(&"Error: could not connect to UDP port:" [ targetPortNumber]);
+        engine.setDestination(targetHostName.toStdString(), targetPortNumber);
+        if (! engine.isConnected()) {
+            juce::Logger::outputDebugString("Error: could not connect to UDP port: " + juce::String(targetPortNumber));
+        }
+    }
+    
+    void setMulticast(bool enabled, juce::String interfaceName, int ttl, bool loopback) {
+        midisender::MulticastOptions options;
+        options.interface = interfaceName.toStdString();
+        options.ttl = ttl;
+        options.loopback = loopback;
+        engine.setMulticast(enabled, options);
+        if (enabled && ! engine.isConnected()) {
+            juce::Logger::outputDebugString("Error: could not join multicast group " + _oscHost + " on interface " + interfaceName);
         }
     }
     
+    void setSync(int syncPort, int snapshotIntervalMs) {
+        engine.setSyncPort(syncPort);
+        engine.setSnapshotInterval(snapshotIntervalMs);
+    }
+    
+    // Pings every unicast destination every intervalMs (0 = off) and converts paced timetags to its clock.
+    void setClockSync(int intervalMs) {
+        engine.setClockSyncInterval(intervalMs);
+    }
+    
+    // Returns an empty string on success, otherwise the offending line.
+    juce::String setRoutingRules(juce::String rulesText) {
+        std::vector<midisender::RoutingRule> rules;
+        std::string error;
+        if (! midisender::parseRoutingRules(rulesText.toStdString(), rules, error)) {
+            juce::Logger::outputDebugString("Error: invalid routing rule, " + juce::String(error));
+            return error;
+        }
+        engine.setRoutingRules(rules);
+        return {};
+    }
+    
+    void setOfflineMode(midisender::OfflineMode mode) {
+        engine.setOfflineMode(mode);
+    }
+    
+    void resetNoteState() {
+        engine.resetNoteState();
+    }
+    
     void sendValue(float value, juce::String name) {
-        if (!_isConnected) return;
-        juce::String root = "/" + _mainID;
-        juce::String address = root + "/" + name;
-        juce::OSCAddressPattern addressPattern = juce::OSCAddressPattern(address);
-        oscSender.send(addressPattern, value);
-    }
-    
-    void sendNoteBundle(int noteNumber, float velocity, int channel, bool noteOn, int timeStamp) {
-        if (!_isConnected) return;
-        juce::String root = "/" + _mainID;
-        juce::String mainName = "midiNote";
-        juce::String noteIdentifier = juce::String(noteNumber);
-        juce::String mainAddress = root + "/" + mainName + "/";
-        
-        OSCBundle bundle = OSCBundle();
-        
-        juce::OSCAddressPattern noteNumberAddress = juce::OSCAddressPattern(mainAddress + "number/" + noteIdentifier);
-        OSCMessage noteNumberMessage = OSCMessage(noteNumberAddress, noteNumber);
-        bundle.addElement(noteNumberMessage);
-        
-        juce::OSCAddressPattern velocityAddress = juce::OSCAddressPattern(mainAddress + "velocity/" + noteIdentifier);
-        OSCMessage velocityMessage = OSCMessage(velocityAddress, velocity);
-        bundle.addElement(velocityMessage);
-        
-        juce::OSCAddressPattern onOffAddress = juce::OSCAddressPattern(mainAddress + "onOff/" + noteIdentifier);
-        OSCMessage onOffMessage = OSCMessage(onOffAddress, noteOn);
-        bundle.addElement(onOffMessage);
-        
-//        juce::OSCAddressPattern channelAddress = juce::OSCAddressPattern(mainAddress + "channel/");
-//        OSCMessage channelMessage = OSCMessage(channelAddress, channel);
-//        bundle.addElement(channelMessage);
-        
-        oscSender.send(bundle);
+        engine.sendValue(value, name.toStdString());
+    }
+    
+    // Streams the macros as /<mainId>/param/macro<n>, every one with the same rate cap and smoothing.
+    void setParameterStream(float maxRateHz, float smoothingMs) {
+        std::vector<midisender::StreamedParameter> parameters;
+        for (int i = 0; i < NUM_MACRO_PARAMETERS; ++i)
+            parameters.push_back({ "macro" + std::to_string(i + 1), maxRateHz, smoothingMs });
+        engine.setStreamedParameters(parameters);
+    }
+    
+    // The audio thread reaches the engine through a midisender::BlockProcessor.
+    midisender::OscEngine& getEngine() {
+        return engine;
+    }
+    
+    // Running send totals for the soak monitor, any thread.
+    midisender::SoakCounters getCounters() const {
+        midisender::SoakCounters counters;
+        counters.sent = engine.getNumSent();
+        counters.sendFailures = engine.getNumSendFailures();
+        counters.dropped = engine.getNumDropped();
+        return counters;
     }
     
 private:
-    juce::OSCSender oscSender;
+    midisender::OscEngine engine;
     juce::String _oscHost;
     juce::String _mainID;
     int _oscPort;
-    bool _isConnected;
 };
 
 class OscHostListener
@@ -96,5 +128,10 @@ public:
     virtual ~OscHostListener() = default;
     virtual void oscHostHasChanged (juce::String newOscHostAdress) = 0;
     virtual void oscMainIDHasChanged (juce::String newOscMainID) = 0;
+    virtual void oscMulticastHasChanged (bool enabled, juce::String interfaceName, int ttl, bool loopback) = 0;
+    virtual void oscSyncHasChanged (int syncPort, int snapshotIntervalMs) = 0;
+    virtual juce::String oscRoutingHasChanged (juce::String rulesText) = 0;
+    virtual void oscOfflineModeHasChanged (midisender::OfflineMode mode) = 0;
+    virtual void oscParameterStreamHasChanged (float maxRateHz, float smoothingMs) = 0;
+    virtual void oscClockSyncHasChanged (int intervalMs) = 0;
 };
-
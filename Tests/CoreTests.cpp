@@ -0,0 +1,1344 @@
+//
+//  CoreTests.cpp
+//  MidiSender
+//
+
+#include "TestHarness.h"
+
+#include "Core/BlockProcessor.h"
+#include "Core/ClockSync.h"
+#include "Core/LoadGenerator.h"
+#include "Core/MidiEvent.h"
+#include "Core/MidiOscEncoder.h"
+#include "Core/MidiTransform.h"
+#include "Core/OscEngine.h"
+#include "Core/OfflineDispatch.h"
+#include "Core/OscPacket.h"
+#include "Core/ParameterStream.h"
+#include "Core/RoutingTable.h"
+#include "Core/SoakMonitor.h"
+#include "Core/SpscQueue.h"
+#include "Core/SysExPool.h"
+#include "Core/SysExReassembler.h"
+#include "Core/UdpTransport.h"
+
+#if defined(MIDISENDER_REALTIME_CHECKS)
+ #include "RealtimeChecker.h"
+ #include "Core/RealtimeCheck.h"
+
+ #include <mutex>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace midisender;
+
+namespace
+{
+struct ReceivedMessage {
+    std::string address;
+    std::string typeTags;
+    int32_t intValue = 0;
+    float floatValue = 0.0f;
+};
+
+std::vector<ReceivedMessage> decode(const uint8_t* data, size_t size) {
+    std::vector<ReceivedMessage> messages;
+    OscPacketReader::parse(data, size, [&](const OscMessageView& view, uint64_t) {
+        ReceivedMessage message;
+        message.address = std::string(view.address);
+        message.typeTags = std::string(view.typeTags);
+        view.getInt32(0, message.intValue);
+        view.getFloat32(0, message.floatValue);
+        messages.push_back(message);
+    });
+    return messages;
+}
+
+MidiEvent noteOn(int channel, int note, int velocity) {
+    const uint8_t bytes[] = { uint8_t(0x90 | (channel - 1)), uint8_t(note), uint8_t(velocity) };
+    return MidiEvent::fromBytes(bytes, 3, 0);
+}
+}
+
+TEST(midiEventDecodesChannelMessages) {
+    auto on = noteOn(3, 60, 100);
+    EXPECT(on.type == MidiEvent::Type::noteOn);
+    EXPECT(on.channel == 3);
+    EXPECT(on.data1 == 60);
+    EXPECT(on.data2 == 100);
+
+    auto zeroVelocity = noteOn(1, 60, 0);
+    EXPECT(zeroVelocity.type == MidiEvent::Type::noteOff);
+
+    const uint8_t cc[] = { 0xb0, 7, 127 };
+    EXPECT(MidiEvent::fromBytes(cc, 3, 5).type == MidiEvent::Type::controlChange);
+    EXPECT(MidiEvent::fromBytes(cc, 3, 5).samplePosition == 5);
+
+    const uint8_t sysex[] = { 0xf0, 0x7e, 0xf7 };
+    EXPECT(MidiEvent::fromBytes(sysex, 3, 0).type == MidiEvent::Type::other);
+}
+
+TEST(spscQueueIsFifoAndBounded) {
+    SpscQueue<int> queue(3);
+    EXPECT(queue.capacity() == 4);
+    for (int i = 0; i < 4; ++i)
+        EXPECT(queue.push(i));
+    EXPECT(! queue.push(4));
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        EXPECT(queue.pop(value));
+        EXPECT(value == i);
+    }
+    EXPECT(! queue.pop(value));
+}
+
+TEST(oscWriterRoundTripsThroughReader) {
+    OscPacketWriter writer(256);
+    REQUIRE(writer.beginMessage("/a/b", "ifs"));
+    EXPECT(writer.addInt32(-7));
+    EXPECT(writer.addFloat32(0.5f));
+    EXPECT(writer.addString("hello"));
+    REQUIRE(writer.endMessage());
+    EXPECT(writer.size() % 4 == 0);
+
+    int numMessages = 0;
+    EXPECT(OscPacketReader::parse(writer.data(), writer.size(), [&](const OscMessageView& view, uint64_t) {
+        ++numMessages;
+        int32_t i = 0;
+        float f = 0.0f;
+        std::string_view s;
+        EXPECT(view.address == "/a/b");
+        EXPECT(view.getInt32(0, i) && i == -7);
+        EXPECT(view.getFloat32(1, f) && f == 0.5f);
+        EXPECT(view.getString(2, s) && s == "hello");
+    }));
+    EXPECT(numMessages == 1);
+}
+
+TEST(oscWriterReportsOverflow) {
+    OscPacketWriter writer(16);
+    EXPECT(! (writer.beginMessage("/a/very/long/address", "i") && writer.addInt32(1) && writer.endMessage()));
+    EXPECT(writer.hasOverflowed());
+}
+
+TEST(encoderWritesNoteBundle) {
+    MidiOscEncoder encoder;
+    encoder.setMainId("piano");
+    OscPacketWriter writer;
+    REQUIRE(encoder.encodeNote(noteOn(1, 64, 127), writer));
+
+    const auto messages = decode(writer.data(), writer.size());
+    REQUIRE(messages.size() == 3);
+    EXPECT(messages[0].address == "/piano/midiNote/number/64");
+    EXPECT(messages[0].typeTags == "i" && messages[0].intValue == 64);
+    EXPECT(messages[1].address == "/piano/midiNote/velocity/64");
+    EXPECT(messages[1].typeTags == "f" && messages[1].floatValue == 1.0f);
+    EXPECT(messages[2].address == "/piano/midiNote/onOff/64");
+    EXPECT(messages[2].intValue == 1);
+
+    const uint8_t cc[] = { 0xb0, 1, 2 };
+    EXPECT(! encoder.encodeNote(MidiEvent::fromBytes(cc, 3, 0), writer));
+}
+
+TEST(engineSendsQueuedNotesOverUdp) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setMainId("track");
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    REQUIRE(engine.isConnected());
+
+    EXPECT(engine.pushEvent(noteOn(1, 60, 64)));
+    engine.dispatchPending();
+
+    uint8_t buffer[1536];
+    const int size = receiver.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    const auto messages = decode(buffer, (size_t) size);
+    REQUIRE(messages.size() == 3);
+    EXPECT(messages[0].address == "/track/midiNote/number/60");
+    EXPECT(engine.getNumSent() == 1);
+    EXPECT(engine.getNumDropped() == 0);
+}
+
+TEST(multicastAddressDetection) {
+    EXPECT(isMulticastAddress("239.255.0.1"));
+    EXPECT(isMulticastAddress("224.0.0.1"));
+    EXPECT(isMulticastAddress("ff02::1"));
+    EXPECT(! isMulticastAddress("127.0.0.1"));
+    EXPECT(! isMulticastAddress("localhost"));
+
+    UdpSender sender;
+    MulticastOptions options;
+    EXPECT(! sender.connect("127.0.0.1", 9001, &options));
+}
+
+TEST(engineSendsToMulticastGroupOnLoopback) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+    if (! receiver.joinMulticastGroup(DEFAULT_MULTICAST_GROUP, "127.0.0.1")) {
+        std::printf("  skipped: loopback interface does not accept multicast membership\n");
+        return;
+    }
+
+    OscEngine engine;
+    MulticastOptions options;
+    options.interface = "127.0.0.1";
+    options.loopback = true;
+    engine.setDestination(DEFAULT_MULTICAST_GROUP, receiver.getBoundPort());
+    engine.setMulticast(true, options);
+    REQUIRE(engine.isConnected());
+    EXPECT(engine.isMulticast());
+
+    EXPECT(engine.pushEvent(noteOn(1, 62, 90)));
+    engine.dispatchPending();
+
+    uint8_t buffer[1536];
+    const int size = receiver.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    const auto messages = decode(buffer, (size_t) size);
+    REQUIRE(messages.size() == 3);
+    EXPECT(messages[0].address == "/" DEFAULT_OSC_MAIN_ID "/midiNote/number/62");
+}
+
+TEST(activeNoteStateTracksHeldNotes) {
+    ActiveNoteState state;
+    state.apply(noteOn(1, 60, 100));
+    state.apply(noteOn(16, 127, 5));
+    state.apply(noteOn(2, 10, 64));
+    state.apply(noteOn(2, 10, 0));   // note-off by zero velocity
+
+    ActiveNoteState::Snapshot snapshot;
+    state.read(snapshot);
+    EXPECT(snapshot.getNumActive() == 2);
+    EXPECT(snapshot.isActive(0, 60) && snapshot.getVelocity(0, 60) == 100);
+    EXPECT(snapshot.isActive(15, 127) && snapshot.getVelocity(15, 127) == 5);
+    EXPECT(! snapshot.isActive(1, 10));
+
+    state.reset();
+    state.read(snapshot);
+    EXPECT(snapshot.getNumActive() == 0);
+}
+
+TEST(encoderWritesNoteStateBlob) {
+    ActiveNoteState state;
+    state.apply(noteOn(1, 60, 100));
+    state.apply(noteOn(3, 9, 33));
+    ActiveNoteState::Snapshot snapshot;
+    state.read(snapshot);
+
+    MidiOscEncoder encoder;
+    OscPacketWriter writer(4096);
+    REQUIRE(encoder.encodeNoteState(snapshot, writer));
+
+    int numMessages = 0;
+    OscPacketReader::parse(writer.data(), writer.size(), [&](const OscMessageView& view, uint64_t) {
+        ++numMessages;
+        int32_t numActive = 0;
+        const uint8_t* blob = nullptr;
+        size_t blobSize = 0;
+        EXPECT(view.address == "/" DEFAULT_OSC_MAIN_ID "/noteState");
+        EXPECT(view.getInt32(0, numActive) && numActive == 2);
+        REQUIRE(view.getBlob(1, blob, blobSize));
+        REQUIRE(blobSize == MidiOscEncoder::noteStateBitmapSize + 2);
+        EXPECT(blob[0 * 16 + 60 / 8] == (1 << (60 % 8)));
+        EXPECT(blob[2 * 16 + 9 / 8] == (1 << (9 % 8)));
+        EXPECT(blob[MidiOscEncoder::noteStateBitmapSize] == 100);
+        EXPECT(blob[MidiOscEncoder::noteStateBitmapSize + 1] == 33);
+    });
+    EXPECT(numMessages == 1);
+}
+
+TEST(engineAnswersSyncQueryWithSnapshot) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    UdpReceiver portProbe;
+    REQUIRE(portProbe.bind(0));
+    const int syncPort = portProbe.getBoundPort();
+    portProbe.close();
+
+    OscEngine engine;
+    engine.setSnapshotInterval(0);
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setSyncPort(syncPort);
+    REQUIRE(engine.isConnected());
+    engine.pushEvent(noteOn(1, 48, 80));
+
+    uint8_t buffer[4096];
+    // Drain the note bundle first
+    REQUIRE(receiver.receive(buffer, sizeof(buffer), 1000) > 0);
+
+    OscPacketWriter query;
+    query.beginMessage("/" DEFAULT_OSC_MAIN_ID "/sync", "");
+    query.endMessage();
+    UdpSender client;
+    REQUIRE(client.connect("127.0.0.1", syncPort));
+
+    bool gotSnapshot = false;
+    for (int attempt = 0; attempt < 50 && ! gotSnapshot; ++attempt) {
+        client.send(query.data(), query.size());
+        const int size = receiver.receive(buffer, sizeof(buffer), 100);
+        if (size > 0)
+            gotSnapshot = decode(buffer, (size_t) size)[0].address == "/" DEFAULT_OSC_MAIN_ID "/noteState";
+    }
+    EXPECT(gotSnapshot);
+    EXPECT(engine.getBoundSyncPort() == syncPort);
+}
+
+TEST(routingRulesParse) {
+    std::vector<RoutingRule> rules;
+    std::string error;
+    REQUIRE(parseRoutingRules("# zones\n"
+                              "1 0-59 notes 10.0.0.2:9001 left\n"
+                              "* 60 notes,other :9100 *   # one key\n"
+                              "2 0-127 all * right\n", rules, error));
+    REQUIRE(rules.size() == 3);
+    EXPECT(rules[0].channel == 1 && rules[0].lowKey == 0 && rules[0].highKey == 59);
+    EXPECT(rules[0].types == RoutingRule::notes);
+    EXPECT(rules[0].host == "10.0.0.2" && rules[0].port == 9001 && rules[0].mainId == "left");
+    EXPECT(rules[1].channel == 0 && rules[1].lowKey == 60 && rules[1].highKey == 60);
+    EXPECT(rules[1].types == RoutingRule::allMessages);
+    EXPECT(rules[1].host.empty() && rules[1].port == 9100 && rules[1].mainId.empty());
+    EXPECT(rules[2].usesDefaultDestination() && rules[2].types == RoutingRule::allMessages);
+
+    EXPECT(! parseRoutingRules("17 0-127 all * x", rules, error));
+    EXPECT(error.find("line 1") == 0);
+    EXPECT(! parseRoutingRules("1 80-20 notes * x", rules, error));
+    EXPECT(! parseRoutingRules("1 0-127 drums * x", rules, error));
+    EXPECT(! parseRoutingRules("1 0-127 cc * x", rules, error));
+
+    REQUIRE(parseRoutingRules("* 0-127 all [ff02::1]:9001 x\n* 0-127 all [::1] y", rules, error));
+    EXPECT(rules[0].host == "ff02::1" && rules[0].port == 9001);
+    EXPECT(rules[1].host == "::1" && rules[1].port == 0);
+    EXPECT(! parseRoutingRules("* 0-127 all ff02::1:9001 x", rules, error));
+    EXPECT(error.find("brackets") != std::string::npos);
+    EXPECT(! parseRoutingRules("* 0-127 all [ff02::1]9001 x", rules, error));
+    EXPECT(! parseRoutingRules("5 0-127 other host:9000 x", rules, error));
+    EXPECT(error.find("no channel") != std::string::npos);
+}
+
+TEST(routingTableFirstMatchWins) {
+    std::vector<RoutingRule> rules(2);
+    rules[0].channel = 1;
+    rules[0].highKey = 59;
+    rules[0].types = RoutingRule::notes;
+    rules[1].types = RoutingRule::notes | RoutingRule::otherMessages;
+
+    RoutingTable table;
+    table.compile(rules);
+    EXPECT(table.lookup(noteOn(1, 40, 1)) == 1);
+    EXPECT(table.lookup(noteOn(1, 60, 1)) == 2);
+    EXPECT(table.lookup(noteOn(5, 40, 1)) == 2);
+
+    MidiEvent sysEx;
+    sysEx.type = MidiEvent::Type::sysEx;
+    EXPECT(table.lookup(sysEx) == 2);
+
+    rules[1].types = RoutingRule::notes;
+    table.compile(rules, 7);
+    EXPECT(table.lookup(sysEx) == RoutingTable::defaultRoute);
+    EXPECT(table.getGeneration() == 7);
+
+    // SysEx has no channel, so a rule for one channel only routes its notes
+    rules[0].types = RoutingRule::allMessages;
+    table.compile(rules);
+    EXPECT(table.lookup(noteOn(1, 40, 1)) == 1);
+    EXPECT(table.lookup(sysEx) == RoutingTable::defaultRoute);
+}
+
+TEST(engineRoutesByChannelToSeparateDestinations) {
+    UdpReceiver main, zone;
+    REQUIRE(main.bind(0));
+    REQUIRE(zone.bind(0));
+
+    OscEngine engine;
+    engine.setDestination("127.0.0.1", main.getBoundPort());
+
+    std::vector<RoutingRule> rules;
+    std::string error;
+    REQUIRE(parseRoutingRules("2 0-127 notes 127.0.0.1:" + std::to_string(zone.getBoundPort()) + " zone", rules, error));
+    engine.setRoutingRules(rules);
+    engine.beginBlock();
+    engine.pushEvent(noteOn(1, 60, 100));
+    engine.pushEvent(noteOn(2, 61, 100));
+    engine.dispatchPending();
+
+    uint8_t buffer[1536];
+    int size = main.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    EXPECT(decode(buffer, (size_t) size)[0].address == "/" DEFAULT_OSC_MAIN_ID "/midiNote/number/60");
+    size = zone.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    EXPECT(decode(buffer, (size_t) size)[0].address == "/zone/midiNote/number/61");
+}
+
+TEST(engineKeepsRoutesOfEventsQueuedBeforeARuleChange) {
+    UdpReceiver first, second;
+    REQUIRE(first.bind(0));
+    REQUIRE(second.bind(0));
+
+    OscEngine engine;
+    engine.setDestination("127.0.0.1", 9);
+
+    std::vector<RoutingRule> rules;
+    std::string error;
+    REQUIRE(parseRoutingRules("2 0-127 notes 127.0.0.1:" + std::to_string(first.getBoundPort()) + " first", rules, error));
+    engine.setRoutingRules(rules);
+    engine.beginBlock();
+    engine.pushEvent(noteOn(2, 60, 100));
+
+    // Same route index, new destination, while the first event is still queued
+    REQUIRE(parseRoutingRules("2 0-127 notes 127.0.0.1:" + std::to_string(second.getBoundPort()) + " second", rules, error));
+    engine.setRoutingRules(rules);
+    engine.dispatchPending();
+
+    engine.beginBlock();
+    engine.pushEvent(noteOn(2, 61, 100));
+    engine.dispatchPending();
+
+    uint8_t buffer[1536];
+    int size = first.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    EXPECT(decode(buffer, (size_t) size)[0].address == "/first/midiNote/number/60");
+    size = second.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    EXPECT(decode(buffer, (size_t) size)[0].address == "/second/midiNote/number/61");
+    EXPECT(first.receive(buffer, sizeof(buffer), 50) < 0);
+}
+
+TEST(engineSendsEachDestinationItsOwnSnapshotAndParameters) {
+    UdpReceiver main, zone;
+    REQUIRE(main.bind(0));
+    REQUIRE(zone.bind(0));
+
+    OscEngine engine;
+    engine.setSnapshotInterval(0);
+    engine.setDestination("127.0.0.1", main.getBoundPort());
+    engine.setStreamedParameters({ { "macro1" } });
+
+    // Two rules to the same receiver share one snapshot.
+    const auto zoneAddress = "127.0.0.1:" + std::to_string(zone.getBoundPort());
+    std::vector<RoutingRule> rules;
+    std::string error;
+    REQUIRE(parseRoutingRules("2 0-59 notes " + zoneAddress + " zone\n"
+                              "2 60-127 notes " + zoneAddress + " zone\n", rules, error));
+    engine.setRoutingRules(rules);
+    engine.beginBlock();
+    engine.pushEvent(noteOn(1, 60, 100));
+    engine.pushEvent(noteOn(2, 40, 90));
+    engine.pushEvent(noteOn(2, 70, 80));
+    engine.dispatchPending();
+    engine.setParameterValue(0, 0.5f);
+    engine.streamParameters();
+    REQUIRE(engine.sendSnapshot());
+
+    auto collect = [](UdpReceiver& receiver, const std::string& mainId, int& numSnapshots, int& numActive, bool& gotParameter) {
+        uint8_t buffer[4096];
+        int size;
+        while ((size = receiver.receive(buffer, sizeof(buffer), 200)) > 0) {
+            OscPacketReader::parse(buffer, (size_t) size, [&](const OscMessageView& view, uint64_t) {
+                int32_t count = 0;
+                if (view.address == "/" + mainId + "/noteState" && view.getInt32(0, count)) {
+                    ++numSnapshots;
+                    numActive = count;
+                }
+                float value = 0.0f;
+                gotParameter |= view.address == "/" + mainId + "/param/macro1" && view.getFloat32(0, value) && value == 0.5f;
+            });
+        }
+    };
+
+    int mainSnapshots = 0, mainActive = -1, zoneSnapshots = 0, zoneActive = -1;
+    bool mainParameter = false, zoneParameter = false;
+    collect(main, DEFAULT_OSC_MAIN_ID, mainSnapshots, mainActive, mainParameter);
+    collect(zone, "zone", zoneSnapshots, zoneActive, zoneParameter);
+    EXPECT(mainSnapshots == 1 && mainActive == 1);
+    EXPECT(zoneSnapshots == 1 && zoneActive == 2);
+    EXPECT(mainParameter && zoneParameter);
+}
+
+TEST(offlinePacerReleasesEventsAtSongTime) {
+    using Clock = OfflinePacer::Clock;
+    OfflinePacer pacer(3);
+    const auto start = Clock::now();
+
+    MidiEvent event = noteOn(1, 60, 100);
+    event.time = 10.0;
+    EXPECT(pacer.schedule(event, start));
+    event.time = 10.5;
+    EXPECT(pacer.schedule(event, start));
+    event.time = 12.0;
+    EXPECT(pacer.schedule(event, start));
+    EXPECT(! pacer.schedule(event, start));
+
+    std::vector<double> released;
+    auto collect = [&](const MidiEvent& due, Clock::time_point, const uint8_t*) { released.push_back(due.time); };
+    pacer.releaseDue(start, collect);
+    EXPECT(released.size() == 1);
+    pacer.releaseDue(start + std::chrono::milliseconds(600), collect);
+    EXPECT(released.size() == 2);
+    pacer.releaseDue(start + std::chrono::seconds(2), collect);
+    EXPECT(released.size() == 3 && pacer.getNumPending() == 0);
+}
+
+TEST(oscTimeTagUsesNtpEpoch) {
+    const auto unixEpoch = std::chrono::system_clock::time_point();
+    EXPECT(oscTimeTagFromSystemTime(unixEpoch) == (uint64_t(2208988800u) << 32));
+    const auto halfSecond = oscTimeTagFromSystemTime(unixEpoch + std::chrono::milliseconds(500));
+    EXPECT((halfSecond & 0xffffffffu) == 0x80000000u);
+}
+
+TEST(engineSuppressesOrLogsOfflineRenders) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setOfflineLogFolder("/tmp");
+
+    BlockContext offline;
+    offline.isNonRealtime = true;
+    offline.timeInSeconds = 2.0;
+    offline.sampleRate = 1000.0;
+
+    engine.setOfflineMode(OfflineMode::suppress);
+    engine.beginBlock(offline);
+    engine.pushEvent(noteOn(1, 60, 100));
+    engine.dispatchPending();
+    uint8_t buffer[1536];
+    EXPECT(receiver.receive(buffer, sizeof(buffer), 50) < 0);
+
+    engine.setOfflineMode(OfflineMode::writeToFile);
+    auto event = noteOn(1, 61, 127);
+    event.samplePosition = 250;
+    engine.pushEvent(event);
+    engine.dispatchPending();
+    EXPECT(receiver.receive(buffer, sizeof(buffer), 50) < 0);
+
+    const auto path = engine.getOfflineLogPath();
+    REQUIRE(! path.empty());
+    std::ifstream log(path);
+    std::string line;
+    REQUIRE(std::getline(log, line));
+    EXPECT(line == "2.250000 /" DEFAULT_OSC_MAIN_ID "/midiNote/number/61 i 61");
+    std::remove(path.c_str());
+}
+
+TEST(engineSnapshotLeavesOutSuppressedBounces) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setSnapshotInterval(0);
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setOfflineMode(OfflineMode::suppress);
+
+    BlockContext offline;
+    offline.isNonRealtime = true;
+    engine.beginBlock(offline);
+    engine.pushEvent(noteOn(1, 60, 100));
+    engine.dispatchPending();
+    REQUIRE(engine.sendSnapshot());
+
+    uint8_t buffer[4096];
+    const int size = receiver.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    const auto messages = decode(buffer, (size_t) size);
+    EXPECT(messages[0].address == "/" DEFAULT_OSC_MAIN_ID "/noteState");
+    EXPECT(messages[0].intValue == 0);
+}
+
+TEST(engineFlushesPacedEventsWhenRealtimeResumes) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setSnapshotInterval(0);
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setOfflineMode(OfflineMode::paceToWallClock);
+
+    BlockContext offline;
+    offline.isNonRealtime = true;
+    offline.sampleRate = 1000.0;
+    engine.beginBlock(offline);
+    engine.pushEvent(noteOn(1, 60, 100));
+    auto late = noteOn(1, 61, 100);
+    late.samplePosition = 30000;   // 30 s into the render
+    engine.pushEvent(late);
+    engine.dispatchPending();
+    EXPECT(engine.getNumPacedPending() == 1);
+
+    engine.beginBlock();
+    engine.pushEvent(noteOn(1, 62, 100));
+    engine.dispatchPending();
+    EXPECT(engine.getNumPacedPending() == 0);
+    REQUIRE(engine.sendSnapshot());
+
+    std::vector<std::string> addresses;
+    int32_t numHeld = -1;
+    uint8_t buffer[4096];
+    int size;
+    while ((size = receiver.receive(buffer, sizeof(buffer), 200)) > 0) {
+        for (const auto& message : decode(buffer, (size_t) size)) {
+            addresses.push_back(message.address);
+            if (message.address == "/" DEFAULT_OSC_MAIN_ID "/noteState")
+                numHeld = message.intValue;
+        }
+    }
+    const auto sent = [&](const std::string& address) {
+        return std::find(addresses.begin(), addresses.end(), "/" DEFAULT_OSC_MAIN_ID "/" + address) != addresses.end();
+    };
+    EXPECT(sent("midiNote/number/60") && sent("midiNote/number/61") && sent("midiNote/number/62"));
+    EXPECT(numHeld == 3);
+}
+
+TEST(engineStartsEachRenderAfreshAfterAnEmptyRealtimeBlock) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setSnapshotInterval(0);
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setOfflineLogFolder("/tmp");
+
+    BlockContext offline;
+    offline.isNonRealtime = true;
+    offline.sampleRate = 1000.0;
+    const auto render = [&](int firstNote, double timeInSeconds) {
+        offline.timeInSeconds = timeInSeconds;
+        engine.beginBlock(offline);
+        engine.pushEvent(noteOn(1, firstNote, 100));
+        auto later = noteOn(1, firstNote + 1, 100);
+        later.samplePosition = 100;
+        engine.pushEvent(later);
+        engine.dispatchPending();
+        engine.beginBlock();   // back to realtime, without any MIDI
+        engine.dispatchPending();
+    };
+
+    // Paced: the second render is anchored anew, so its later note is held
+    // back rather than due on the first render's clock.
+    engine.setOfflineMode(OfflineMode::paceToWallClock);
+    render(60, 0.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    offline.timeInSeconds = 0.1;
+    engine.beginBlock(offline);
+    engine.pushEvent(noteOn(1, 70, 100));
+    auto later = noteOn(1, 71, 100);
+    later.samplePosition = 100;
+    engine.pushEvent(later);
+    engine.dispatchPending();
+    EXPECT(engine.getNumPacedPending() == 1);
+
+    // Logged: each render gets its own file, even within the same second.
+    engine.setOfflineMode(OfflineMode::writeToFile);
+    render(40, 1.0);
+    const auto first = engine.getOfflineLogPath();
+    render(50, 2.0);
+    const auto second = engine.getOfflineLogPath();
+    REQUIRE(! first.empty() && first != second);
+
+    std::ifstream firstLog(first), secondLog(second);
+    std::string line, firstText;
+    while (std::getline(firstLog, line))
+        firstText += line + "\n";
+    EXPECT(firstText.find("/midiNote/number/41") != std::string::npos);
+    EXPECT(firstText.find("/midiNote/number/50") == std::string::npos);
+    REQUIRE(std::getline(secondLog, line));
+    EXPECT(line == "2.000000 /" DEFAULT_OSC_MAIN_ID "/midiNote/number/50 i 50");
+    std::remove(first.c_str());
+    std::remove(second.c_str());
+}
+
+TEST(fileLogNamesAreUniqueAndStayInTheirFolder) {
+    OscFileLog first, second;
+    REQUIRE(first.open("/tmp", "a/b c"));
+    REQUIRE(second.open("/tmp", "a/b c"));
+    EXPECT(first.getPath() != second.getPath());
+    EXPECT(first.getPath().rfind('/') == 4 && first.getPath().find("a_b_c-") == 5);
+    first.close();
+    second.close();
+    std::remove(first.getPath().c_str());
+    std::remove(second.getPath().c_str());
+}
+
+TEST(transformTablesTransposeAndFoldIntoRange) {
+    MidiTransformSettings settings;
+    settings.transpose = 5;
+    settings.lowKey = 48;
+    settings.highKey = 72;
+    const auto tables = MidiTransformTables::compile(settings);
+    EXPECT(tables.note[60] == 65);
+    EXPECT(tables.note[20] == 49);    // 25 folded up by octaves
+    EXPECT(tables.note[120] == 65);   // 125 folded down by octaves
+    EXPECT(tables.channel[3] == 3);
+
+    settings.lowKey = settings.highKey = 60;
+    EXPECT(MidiTransformTables::compile(settings).note[0] == 60);
+
+    EXPECT(curves::fixed[1] == 127 && curves::fixed[0] == 0);
+    EXPECT(curves::hard[1] == 1);     // a note-on never becomes a note-off
+}
+
+TEST(transformStageKeepsNoteOffsWithTheirNoteOn) {
+    MidiTransformStage stage;
+    MidiTransformSettings settings;
+    settings.transpose = 12;
+    settings.outputChannel = 10;
+    settings.velocityCurve = VelocityCurve::fixed;
+    stage.setSettings(settings);
+    stage.beginBlock();
+
+    uint8_t on[] = { 0x90, 60, 30 };
+    stage.process(on, 3);
+    EXPECT(on[0] == 0x99 && on[1] == 72 && on[2] == 127);
+
+    // Settings change while the note is held
+    stage.setSettings({});
+    stage.beginBlock();
+
+    uint8_t off[] = { 0x80, 60, 0 };
+    stage.process(off, 3);
+    EXPECT(off[0] == 0x89 && off[1] == 72);
+
+    uint8_t cc[] = { 0xb2, 7, 100 };
+    stage.process(cc, 3);
+    EXPECT(cc[0] == 0xb2 && cc[1] == 7 && cc[2] == 100);
+
+    uint8_t sysex[] = { 0xf0, 0x01, 0xf7 };
+    stage.process(sysex, 3);
+    EXPECT(sysex[0] == 0xf0 && sysex[1] == 0x01);
+}
+
+TEST(blockProcessorTransformsInPlaceAndSendsNotes) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setMainId("track");
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    MidiTransformStage transform;
+    MidiTransformSettings settings;
+    settings.transpose = 12;
+    transform.setSettings(settings);
+    BlockProcessor processor(engine, transform);
+
+    processor.beginBlock({});
+    uint8_t cc[] = { 0xb0, 7, 100 };
+    processor.processMessage(cc, 3, 0);
+    uint8_t on[] = { 0x90, 60, 64 };
+    processor.processMessage(on, 3, 10);
+    processor.endBlock(256);
+    EXPECT(on[1] == 72);   // the host's buffer sees the transformed note too
+
+    engine.dispatchPending();
+    uint8_t buffer[1536];
+    const int size = receiver.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    const auto messages = decode(buffer, (size_t) size);
+    REQUIRE(! messages.empty());
+    EXPECT(messages[0].address == "/track/midiNote/number/72");
+    EXPECT(engine.getNumSent() == 1);
+}
+
+TEST(parameterStreamCapsRateAndSendsTheLastValue) {
+    ParameterStream stream;
+    stream.setParameters({ { "cutoff", 50.0f, 0.0f } });
+
+    std::vector<float> sent;
+    const auto send = [&](int index, float value) { EXPECT(index == 0); sent.push_back(value); };
+    const auto start = ParameterStream::Clock::now();
+    const auto at = [start](int milliseconds) { return start + std::chrono::milliseconds(milliseconds); };
+
+    stream.setValue(0, 0.25f);
+    stream.update(at(0), send);
+    REQUIRE(sent.size() == 1);
+    EXPECT(sent[0] == 0.25f);
+
+    // Three changes inside one 20 ms window collapse into the last one
+    stream.setValue(0, 0.3f);
+    stream.update(at(5), send);
+    stream.setValue(0, 0.4f);
+    stream.update(at(10), send);
+    stream.setValue(0, 0.5f);
+    stream.update(at(15), send);
+    EXPECT(sent.size() == 1);
+    stream.update(at(20), send);
+    REQUIRE(sent.size() == 2);
+    EXPECT(sent[1] == 0.5f);
+
+    // Same value again: nothing to send
+    stream.setValue(0, 0.5f);
+    stream.update(at(60), send);
+    EXPECT(sent.size() == 2);
+}
+
+TEST(parameterStreamSmoothsTowardsTheTarget) {
+    ParameterStream stream;
+    stream.setParameters({ { "level", 0.0f, 10.0f } });
+
+    std::vector<float> sent;
+    const auto send = [&](int, float value) { sent.push_back(value); };
+    const auto start = ParameterStream::Clock::now();
+
+    stream.setValue(0, 0.0f);
+    stream.update(start, send);
+    stream.setValue(0, 1.0f);
+    for (int ms = 1; ms <= 200; ++ms)
+        stream.update(start + std::chrono::milliseconds(ms), send);
+
+    REQUIRE(sent.size() > 10);
+    for (size_t i = 1; i < sent.size(); ++i)
+        EXPECT(sent[i] > sent[i - 1]);
+    EXPECT(sent[1] < 0.2f);
+    EXPECT(sent.back() == 1.0f);
+}
+
+TEST(engineStreamsParametersToPrebuiltAddresses) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setMainId("track");
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setStreamedParameters({ { "macro1" }, { "macro2" } });
+    engine.beginBlock();
+    engine.setParameterValue(0, 0.5f);
+    engine.setParameterValue(1, 0.75f);
+    engine.streamParameters();
+
+    bool gotFirst = false, gotSecond = false;
+    uint8_t buffer[1536];
+    for (int i = 0; i < 4 && ! (gotFirst && gotSecond); ++i) {
+        const int size = receiver.receive(buffer, sizeof(buffer), 1000);
+        REQUIRE(size > 0);
+        for (const auto& message : decode(buffer, (size_t) size)) {
+            gotFirst |= message.address == "/track/param/macro1" && message.floatValue == 0.5f;
+            gotSecond |= message.address == "/track/param/macro2" && message.floatValue == 0.75f;
+        }
+    }
+    EXPECT(gotFirst);
+    EXPECT(gotSecond);
+}
+
+TEST(engineMutesParametersInSuppressedBounces) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setStreamedParameters({ { "macro1" } });
+
+    // Declaring the parameters sends their current values once
+    uint8_t buffer[1536];
+    engine.streamParameters();
+    while (receiver.receive(buffer, sizeof(buffer), 50) > 0) {}
+    engine.setOfflineMode(OfflineMode::suppress);
+
+    BlockContext offline;
+    offline.isNonRealtime = true;
+    engine.beginBlock(offline);
+    engine.setParameterValue(0, 0.5f);
+    engine.dispatchPending();
+    engine.streamParameters();
+    EXPECT(receiver.receive(buffer, sizeof(buffer), 50) < 0);
+}
+
+TEST(enginePacesParametersInBounces) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setSnapshotInterval(0);
+    engine.setMainId("track");
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setStreamedParameters({ { "macro1" } });
+
+    // Declaring the parameters sends their current values once
+    uint8_t buffer[1536];
+    engine.streamParameters();
+    while (receiver.receive(buffer, sizeof(buffer), 50) > 0) {}
+    engine.setOfflineMode(OfflineMode::paceToWallClock);
+
+    BlockContext offline;
+    offline.isNonRealtime = true;
+    engine.beginBlock(offline);
+    engine.setParameterValue(0, 0.25f);
+    offline.timeInSeconds = 30.0;
+    engine.beginBlock(offline);
+    engine.setParameterValue(0, 0.25f);   // unchanged, not queued again
+    engine.setParameterValue(0, 0.5f);
+    engine.dispatchPending();
+    engine.streamParameters();
+
+    const int size = receiver.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    uint64_t timeTag = oscTimeTagImmediately;
+    float value = 0.0f;
+    OscPacketReader::parse(buffer, (size_t) size, [&](const OscMessageView& view, uint64_t bundleTimeTag) {
+        if (view.address == "/track/param/macro1" && view.getFloat32(0, value))
+            timeTag = bundleTimeTag;
+    });
+    EXPECT(value == 0.25f && timeTag != oscTimeTagImmediately);
+    EXPECT(engine.getNumPacedPending() == 1);
+    EXPECT(receiver.receive(buffer, sizeof(buffer), 50) < 0);
+}
+
+TEST(engineLogsParametersInBounces) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setMainId("track");
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setStreamedParameters({ { "macro1" } });
+
+    // Declaring the parameters sends their current values once
+    uint8_t buffer[1536];
+    engine.streamParameters();
+    while (receiver.receive(buffer, sizeof(buffer), 50) > 0) {}
+    engine.setOfflineLogFolder("/tmp");
+    engine.setOfflineMode(OfflineMode::writeToFile);
+
+    BlockContext offline;
+    offline.isNonRealtime = true;
+    offline.timeInSeconds = 2.0;
+    engine.beginBlock(offline);
+    engine.setParameterValue(0, 0.5f);
+    engine.dispatchPending();
+    engine.streamParameters();
+    EXPECT(receiver.receive(buffer, sizeof(buffer), 50) < 0);
+
+    const auto path = engine.getOfflineLogPath();
+    REQUIRE(! path.empty());
+    std::ifstream log(path);
+    std::string line;
+    REQUIRE(std::getline(log, line));
+    EXPECT(line == "2.000000 /track/param/macro1 f 0.5");
+    std::remove(path.c_str());
+}
+
+TEST(sysExPoolSkipsTheRingEndAndReclaimsOnRelease) {
+    SysExPool pool(256);
+    std::vector<uint8_t> message(100, 0x42);
+    uint32_t first, second, third;
+
+    REQUIRE(pool.write(message.data(), 100, first));
+    REQUIRE(pool.write(message.data(), 100, second));
+    // 56 bytes left at the end: too small, and the start is still in use
+    EXPECT(! pool.write(message.data(), 100, third));
+
+    pool.release(first, 100);
+    REQUIRE(pool.write(message.data(), 100, third));
+    EXPECT(third == 256);
+    EXPECT(pool.getData(third) == pool.getData(0));
+
+    pool.discard(third);
+    pool.release(second, 100);
+    REQUIRE(pool.write(message.data(), 100, third));
+    EXPECT(third == 256);
+    EXPECT(! pool.write(message.data(), 300, third));
+}
+
+TEST(sysExReassemblerHandlesFragmentsOutOfOrder) {
+    MidiOscEncoder encoder;
+    OscPacketWriter writer;
+    SysExReassembler reassembler;
+
+    std::vector<uint8_t> message(3000);
+    for (size_t i = 0; i < message.size(); ++i)
+        message[i] = uint8_t(i & 0x7f);
+    message.front() = 0xf0;
+    message.back() = 0xf7;
+
+    const size_t capacity = encoder.getSysExFragmentCapacity();
+    const int count = int((message.size() + capacity - 1) / capacity);
+    REQUIRE(count == 3);
+
+    std::vector<uint8_t> rebuilt;
+    const auto onMessage = [&](const uint8_t* data, size_t size) { rebuilt.assign(data, data + size); };
+    for (int i = count - 1; i >= 0; --i) {
+        const size_t offset = (size_t) i * capacity;
+        REQUIRE(encoder.encodeSysExFragment(7, i, count, message.data() + offset,
+                                            std::min(capacity, message.size() - offset), writer));
+        EXPECT(writer.size() <= MidiOscEncoder::maxDatagramSize);
+        OscPacketReader::parse(writer.data(), writer.size(), [&](const OscMessageView& view, uint64_t) {
+            EXPECT(reassembler.addFragment(view, onMessage));
+        });
+        EXPECT(rebuilt.empty() == (i > 0));
+    }
+    EXPECT(rebuilt == message);
+    EXPECT(reassembler.getNumPending() == 0);
+}
+
+TEST(engineForwardsLargeSysExInFragments) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setMainId("desk");
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+
+    const uint8_t small[] = { 0xf0, 0x7e, 0x7f, 0x06, 0x01, 0xf7 };
+    std::vector<uint8_t> dump(5000, 0x11);
+    dump.front() = 0xf0;
+    dump.back() = 0xf7;
+
+    engine.beginBlock();
+    REQUIRE(engine.pushSysEx(small, (int) sizeof(small), 0));
+    REQUIRE(engine.pushSysEx(dump.data(), (int) dump.size(), 10));
+    engine.dispatchPending();
+
+    SysExReassembler reassembler;
+    std::vector<std::vector<uint8_t>> messages;
+    uint8_t buffer[2048];
+    while (messages.size() < 2) {
+        const int size = receiver.receive(buffer, sizeof(buffer), 1000);
+        REQUIRE(size > 0);
+        EXPECT((size_t) size <= MidiOscEncoder::maxDatagramSize);
+        OscPacketReader::parse(buffer, (size_t) size, [&](const OscMessageView& view, uint64_t) {
+            EXPECT(view.address == "/desk/sysex");
+            reassembler.addFragment(view, [&](const uint8_t* data, size_t length) {
+                messages.emplace_back(data, data + length);
+            });
+        });
+    }
+    EXPECT(messages[0] == std::vector<uint8_t>(small, small + sizeof(small)));
+    EXPECT(messages[1] == dump);
+    EXPECT(engine.getNumDropped() == 0);
+}
+
+TEST(enginePacesSysExWithTheNotesAroundIt) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setSnapshotInterval(0);
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    engine.setOfflineMode(OfflineMode::paceToWallClock);
+
+    BlockContext offline;
+    offline.isNonRealtime = true;
+    offline.sampleRate = 1000.0;
+    engine.beginBlock(offline);
+    engine.pushEvent(noteOn(1, 60, 100));
+    const uint8_t dump[] = { 0xf0, 0x7d, 0x01, 0x02, 0x03, 0xf7 };
+    REQUIRE(engine.pushSysEx(dump, sizeof(dump), 30000));   // 30 s into the render
+    engine.dispatchPending();
+    EXPECT(engine.getNumPacedPending() == 1);
+
+    uint8_t buffer[1536];
+    int size = receiver.receive(buffer, sizeof(buffer), 1000);
+    REQUIRE(size > 0);
+    EXPECT(decode(buffer, (size_t) size)[0].address == "/" DEFAULT_OSC_MAIN_ID "/midiNote/number/60");
+    EXPECT(receiver.receive(buffer, sizeof(buffer), 50) < 0);
+
+    // The pool slot is long reused by the time the render ends
+    const uint8_t other[] = { 0xf0, 0x7d, 0x7f, 0x7f, 0x7f, 0xf7 };
+    engine.beginBlock();
+    REQUIRE(engine.pushSysEx(other, sizeof(other), 0));
+    engine.dispatchPending();
+
+    SysExReassembler reassembler;
+    std::vector<std::vector<uint8_t>> messages;
+    while (messages.size() < 2 && (size = receiver.receive(buffer, sizeof(buffer), 1000)) > 0) {
+        OscPacketReader::parse(buffer, (size_t) size, [&](const OscMessageView& view, uint64_t) {
+            reassembler.addFragment(view, [&](const uint8_t* data, size_t length) {
+                messages.emplace_back(data, data + length);
+            });
+        });
+    }
+    REQUIRE(messages.size() == 2);
+    EXPECT(messages[0] == std::vector<uint8_t>(dump, dump + sizeof(dump)));
+    EXPECT(messages[1] == std::vector<uint8_t>(other, other + sizeof(other)));
+}
+
+TEST(clockEstimatorRejectsQueuedSamplesAndFitsDrift) {
+    constexpr double trueOffset = 0.020;
+    constexpr double trueDrift = 40.0e-6;
+    const uint64_t start = oscTimeTagFromSystemTime(std::chrono::system_clock::now());
+    const auto remote = [&](uint64_t local) {
+        return oscTimeTagAddSeconds(local, trueOffset + trueDrift * oscTimeTagDifference(local, start));
+    };
+
+    ClockEstimator clock;
+    int numRejected = 0;
+    for (int i = 0; i < 40; ++i) {
+        // Small symmetric jitter, and every fourth ping stuck 20 ms in a queue one way
+        const double jitter = 0.0001 * ((i * 7) % 5);
+        const double forward = 0.0005 + jitter + (i % 4 == 3 ? 0.020 : 0.0);
+        const double backward = 0.0005 + 0.0001 * ((i * 3) % 5);
+
+        const uint64_t t1 = oscTimeTagAddSeconds(start, i * 0.5);
+        const uint64_t t2 = remote(oscTimeTagAddSeconds(t1, forward));
+        const uint64_t t3 = oscTimeTagAddSeconds(t2, 0.0001);
+        const uint64_t t4 = oscTimeTagAddSeconds(t1, forward + 0.0001 + backward);
+        numRejected += clock.addSample(t1, t2, t3, t4) ? 0 : 1;
+    }
+
+    EXPECT(numRejected == 10);
+    REQUIRE(clock.hasEstimate());
+    const uint64_t later = oscTimeTagAddSeconds(start, 20.0);
+    EXPECT(std::abs(clock.getOffset(later) - (trueOffset + trueDrift * 20.0)) < 0.0003);
+    EXPECT(std::abs(clock.getDrift() - trueDrift) < 10.0e-6);
+    EXPECT(std::abs(oscTimeTagDifference(clock.toRemote(later), remote(later))) < 0.0003);
+}
+
+TEST(engineConvertsBundleTimeTagsToTheDestinationClock) {
+    ClockResponder responder;
+    REQUIRE(responder.bind(0));
+    responder.simulateClockError(0.25, 0.0);
+
+    std::atomic<bool> running { true };
+    std::atomic<uint64_t> bundleTimeTag { 0 };
+    std::atomic<uint64_t> bundleArrival { 0 };
+    std::thread answering([&] {
+        while (running)
+            responder.answerPending(5, [&](const OscMessageView&, uint64_t timeTag) {
+                if (timeTag != oscTimeTagImmediately && bundleTimeTag == 0) {
+                    bundleArrival = responder.now();
+                    bundleTimeTag = timeTag;
+                }
+            });
+    });
+
+    OscEngine engine;
+    engine.setDestination("127.0.0.1", responder.getBoundPort());
+    engine.setClockSyncInterval(10);
+
+    // Nothing is pinged until bounces are paced, nothing else has absolute timetags.
+    double offset = 0.0, drift = 0.0;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT(! engine.getClockEstimate(0, offset, drift));
+
+    engine.setOfflineMode(OfflineMode::paceToWallClock);
+    for (int i = 0; i < 200 && ! engine.getClockEstimate(0, offset, drift); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT(std::abs(offset - 0.25) < 0.005);
+    EXPECT(! engine.getClockEstimate(1, offset, drift));
+
+    // A paced bounce stamps absolute timetags, which should now read in the responder's time.
+    BlockContext context;
+    context.isNonRealtime = true;
+    engine.beginBlock(context);
+    engine.pushEvent(noteOn(1, 60, 100));
+    for (int i = 0; i < 200 && bundleTimeTag == 0; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    running = false;
+    answering.join();
+    REQUIRE(bundleTimeTag != 0);
+    EXPECT(std::abs(oscTimeTagDifference(bundleTimeTag, bundleArrival)) < 0.05);
+}
+
+TEST(engineDoesNotPingMulticastRoutes) {
+    UdpReceiver group;
+    REQUIRE(group.bind(0));
+    if (! group.joinMulticastGroup(DEFAULT_MULTICAST_GROUP, "127.0.0.1")) {
+        std::printf("  skipped: loopback interface does not accept multicast membership\n");
+        return;
+    }
+
+    ClockResponder responder;
+    REQUIRE(responder.bind(0));
+    std::atomic<bool> running { true };
+    std::thread answering([&] {
+        while (running)
+            responder.answerPending(5, [](const OscMessageView&, uint64_t) {});
+    });
+
+    OscEngine engine;
+    MulticastOptions options;
+    options.interface = "127.0.0.1";
+    options.loopback = true;
+    engine.setDestination(DEFAULT_MULTICAST_GROUP, 9);
+    engine.setMulticast(true, options);
+
+    std::vector<RoutingRule> rules;
+    std::string error;
+    REQUIRE(parseRoutingRules("1 0-127 all " DEFAULT_MULTICAST_GROUP ":" + std::to_string(group.getBoundPort()) + " zone\n"
+                              "2 0-127 all 127.0.0.1:" + std::to_string(responder.getBoundPort()) + " solo\n", rules, error));
+    engine.setRoutingRules(rules);
+    engine.setOfflineMode(OfflineMode::paceToWallClock);
+    engine.setClockSyncInterval(10);
+
+    // The unicast route gets an estimate while the group is never pinged.
+    double offset = 0.0, drift = 0.0;
+    for (int i = 0; i < 200 && ! engine.getClockEstimate(2, offset, drift); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    running = false;
+    answering.join();
+
+    EXPECT(engine.getClockEstimate(2, offset, drift));
+    EXPECT(! engine.getClockEstimate(0, offset, drift));
+    EXPECT(! engine.getClockEstimate(1, offset, drift));
+
+    uint8_t buffer[1536];
+    int size;
+    bool gotPing = false;
+    for (int i = 0; i < 100 && ! gotPing && (size = group.receive(buffer, sizeof(buffer), 50)) > 0; ++i)
+        for (const auto& message : decode(buffer, (size_t) size))
+            gotPing |= message.address.find("/clock/ping") != std::string::npos;
+    EXPECT(! gotPing);
+}
+
+TEST(loadGeneratorMixesTypesAndReleasesEveryNote) {
+    LoadSettings settings;
+    std::string error;
+    REQUIRE(parseLoadSettings("rate=1000 chord=4 length=20 sweep=5 cc=74 channels=2 "
+                              "mix=notes:1,cc:1,bend:1,pressure:1,sysex:1 sysex=100", settings, error));
+    EXPECT(settings.chordSize == 4 && settings.sweepController == 74 && settings.sysExWeight == 1);
+    EXPECT(! parseLoadSettings("rate=fast", settings, error) && error == "rate=fast");
+    EXPECT(! parseLoadSettings("mix=drums:1", settings, error));
+    REQUIRE(parseLoadSettings("rate=1000 chord=4 length=20 sweep=5 cc=74 channels=2 "
+                              "mix=notes:1,cc:1,bend:1,pressure:1,sysex:1 sysex=100", settings, error));
+
+    LoadGenerator generator(settings);
+    int noteOns = 0, noteOffs = 0, sweeps = 0, controllers = 0, bends = 0, pressures = 0, dumps = 0;
+    int lastPosition = -1;
+    bool inBlock = true;
+    const auto count = [&](uint8_t* bytes, int size, int position) {
+        inBlock = inBlock && position >= 0 && position < 480;
+        lastPosition = position;
+        switch (bytes[0] & 0xf0) {
+            case 0x90: ++noteOns; break;
+            case 0x80: ++noteOffs; break;
+            case 0xb0: ++(bytes[1] == 74 && (bytes[0] & 0x0f) == 0 && position == 0 ? sweeps : controllers); break;
+            case 0xe0: ++bends; break;
+            case 0xd0: pressures += size == 2 ? 1 : 0; break;
+            case 0xf0: dumps += size == 100 && bytes[size - 1] == 0xf7 ? 1 : 0; break;
+        }
+    };
+
+    // One second at 48 kHz
+    for (int block = 0; block < 100; ++block)
+        generator.generate(480, 48000.0, count);
+    EXPECT(inBlock);
+    EXPECT(noteOns > 0 && controllers > 0 && bends > 0 && pressures > 0 && dumps > 0);
+    EXPECT(sweeps >= 90);   // at most one per block
+    EXPECT(std::abs(controllers + bends + pressures + dumps - 800) < 100);
+    EXPECT(generator.getNumHeldNotes() == noteOns - noteOffs);
+
+    generator.releaseAll(0, count);
+    EXPECT(noteOns == noteOffs && generator.getNumHeldNotes() == 0);
+    EXPECT(generator.getNumGenerated() == uint64_t(noteOns + noteOffs + sweeps + controllers + bends + pressures + dumps));
+}
+
+TEST(soakMonitorReportsBlockPercentilesAndRotatesItsLog) {
+    EXPECT(SoakMonitor::bucketFor(7) == 7 && SoakMonitor::bucketFor(8) == 8 && SoakMonitor::bucketFor(16) == 16);
+    for (uint64_t ns : { 9ull, 100ull, 1000ull, 123456ull, 987654321ull }) {
+        const auto bucket = SoakMonitor::bucketFor(ns);
+        EXPECT(SoakMonitor::bucketUpperBound(bucket) > ns);
+        EXPECT(bucket == 0 || SoakMonitor::bucketUpperBound(bucket - 1) <= ns);
+    }
+
+    std::atomic<uint64_t> sent { 0 };
+    SoakMonitor monitor;
+    monitor.setCounterSource([&] { return SoakCounters { 0, sent.load(), sent.load() / 10, 0 }; });
+    const std::string path = "/tmp/midisender-soak-test.log";
+    REQUIRE(monitor.start(path, 10000, 64));
+
+    for (int i = 0; i < 990; ++i)
+        monitor.recordBlock(std::chrono::microseconds(100));
+    for (int i = 0; i < 10; ++i)
+        monitor.recordBlock(std::chrono::milliseconds(5));
+    sent = 1000;
+
+    const auto sample = monitor.takeSample();
+    EXPECT(sample.blocks == 1000);
+    EXPECT(sample.p50Us >= 100.0 && sample.p50Us < 115.0);
+    EXPECT(sample.p99Us < 115.0 && sample.maxUs == 5000.0);
+    EXPECT(sample.counters.sent == 1000 && sample.counters.sendFailures == 100);
+    EXPECT(std::abs(sample.failureRate - 100.0 / 1100.0) < 1.0e-9);
+    EXPECT(SoakMonitor::getResidentMemoryKb() > 0);
+
+    // The header alone is past the 64 byte limit, so the line written on stop rotates the log
+    monitor.stop();
+    const auto summary = monitor.getSummary();
+    EXPECT(summary.numSamples == 2 && summary.totals.sendFailures == 100 && summary.worstMaxUs == 5000.0);
+
+    std::ifstream previous(path + ".1");
+    std::string header;
+    EXPECT(std::getline(previous, header) && header.rfind("# elapsed_s rss_kb", 0) == 0);
+    std::remove(path.c_str());
+    std::remove((path + ".1").c_str());
+}
+
+#if defined(MIDISENDER_REALTIME_CHECKS)
+TEST(realtimeCheckerCatchesAllocationsLocksAndSleeps) {
+    std::mutex mutex;
+    tests::ScopedExpectedRealtimeViolations expected;
+    {
+        MIDISENDER_REALTIME_SCOPE;
+        std::string text(64, 'x');
+        { std::lock_guard<std::mutex> guard(mutex); }
+        std::this_thread::sleep_for(std::chrono::microseconds(1));
+    }
+    // malloc + free, the lock and the sleep
+    EXPECT(expected.getCount() >= 4);
+
+    const int before = expected.getCount();
+    { std::string text(64, 'x'); }
+    EXPECT(expected.getCount() == before);
+}
+
+TEST(processBlockPathIsRealtimeSafe) {
+    UdpReceiver receiver;
+    REQUIRE(receiver.bind(0));
+
+    OscEngine engine;
+    engine.setDestination("127.0.0.1", receiver.getBoundPort());
+    std::vector<RoutingRule> rules;
+    std::string error;
+    REQUIRE(parseRoutingRules("2 0-127 all :" + std::to_string(receiver.getBoundPort()) + " zone", rules, error));
+    engine.setRoutingRules(rules);
+    engine.setStreamedParameters({ { "macro1" } });
+
+    std::vector<uint8_t> dump(4000, 0x22);
+    dump.front() = 0xf0;
+    dump.back() = 0xf7;
+
+    MidiTransformStage transform;
+    MidiTransformSettings settings;
+    settings.transpose = 5;
+    transform.setSettings(settings);
+
+    LoadSettings load;
+    load.sysExWeight = 1;
+    LoadGenerator generator(load);
+    SoakMonitor monitor;
+    BlockProcessor processor(engine, transform);
+    processor.setSoakTest(&generator, &monitor);
+
+    // The path OscSenderAudioProcessor::process() runs, without the JUCE buffers.
+    for (int block = 0; block < 200; ++block) {
+        MIDISENDER_REALTIME_SCOPE;
+        BlockContext context;
+        context.timeInSeconds = block * 0.01;
+        processor.beginBlock(context);
+        processor.setParameterValue(0, (block % 10) * 0.1f);
+        if (block % 20 == 0)
+            processor.processMessage(dump.data(), (int) dump.size(), 0);
+        for (int i = 0; i < 8; ++i) {
+            uint8_t bytes[] = { uint8_t((i & 1 ? 0x80 : 0x90) | (block & 1)), uint8_t(48 + i), 100 };
+            processor.processMessage(bytes, 3, i);
+        }
+        processor.endBlock(441);
+    }
+
+    uint8_t buffer[1536];
+    EXPECT(receiver.receive(buffer, sizeof(buffer), 1000) > 0);
+}
+#endif
@@ -0,0 +1,276 @@
+//
+//  RealtimeChecker.cpp
+//  MidiSender
+//
+//  Only linked into the test binary. The definitions below take precedence
+//  over the C library's, check whether the calling thread is inside a
+//  MIDISENDER_REALTIME_SCOPE and then forward to the real implementation.
+//
+
+#include "RealtimeChecker.h"
+
+#include "Core/RealtimeCheck.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if ! defined(MIDISENDER_REALTIME_CHECKS)
+ #error "RealtimeChecker.cpp needs MIDISENDER_REALTIME_CHECKS"
+#endif
+
+#if defined(__GLIBC__)
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <poll.h>
+ #include <pthread.h>
+ #include <sys/socket.h>
+ #include <time.h>
+ #include <unistd.h>
+ #define MIDISENDER_INTERPOSE_LIBC 1
+#endif
+
+namespace
+{
+std::atomic<int> numViolations { 0 };
+thread_local int* expectedViolations = nullptr;
+thread_local bool isReporting = false;
+
+void reportViolation(const char* what) {
+    if (! midisender::realtime::isInRealtimeScope() || isReporting)
+        return;
+
+    isReporting = true;
+    if (expectedViolations != nullptr) {
+        ++*expectedViolations;
+    } else {
+        numViolations.fetch_add(1);
+        std::fprintf(stderr, "  REALTIME VIOLATION: %s called inside a realtime section\n", what);
+#if MIDISENDER_INTERPOSE_LIBC
+        void* frames[32];
+        const int numFrames = backtrace(frames, 32);
+        backtrace_symbols_fd(frames + 1, numFrames - 1, STDERR_FILENO);
+#endif
+    }
+    isReporting = false;
+}
+
+#if MIDISENDER_INTERPOSE_LIBC
+template <typename FunctionType>
+FunctionType next(const char* name) {
+    return reinterpret_cast<FunctionType>(dlsym(RTLD_NEXT, name));
+}
+
+struct RealFunctions {
+    decltype(&::pthread_mutex_lock) mutexLock;
+    decltype(&::pthread_rwlock_rdlock) readLock;
+    decltype(&::pthread_rwlock_wrlock) writeLock;
+    decltype(&::pthread_cond_wait) conditionWait;
+    decltype(&::read) read;
+    decltype(&::write) write;
+    decltype(&::send) send;
+    decltype(&::sendto) sendTo;
+    decltype(&::sendmsg) sendMessage;
+    decltype(&::recv) receive;
+    decltype(&::recvfrom) receiveFrom;
+    decltype(&::recvmsg) receiveMessage;
+    decltype(&::poll) poll;
+    decltype(&::nanosleep) nanosleep;
+    decltype(&::usleep) usleep;
+};
+
+RealFunctions real;
+
+/** Resolved before main() so that no lookup ever happens inside a hook.
+    backtrace() loads its unwinder on first use, so that is done here too. */
+__attribute__((constructor(101))) void initialise() {
+    real.mutexLock = next<decltype(real.mutexLock)>("pthread_mutex_lock");
+    real.readLock = next<decltype(real.readLock)>("pthread_rwlock_rdlock");
+    real.writeLock = next<decltype(real.writeLock)>("pthread_rwlock_wrlock");
+    real.conditionWait = next<decltype(real.conditionWait)>("pthread_cond_wait");
+    real.read = next<decltype(real.read)>("read");
+    real.write = next<decltype(real.write)>("write");
+    real.send = next<decltype(real.send)>("send");
+    real.sendTo = next<decltype(real.sendTo)>("sendto");
+    real.sendMessage = next<decltype(real.sendMessage)>("sendmsg");
+    real.receive = next<decltype(real.receive)>("recv");
+    real.receiveFrom = next<decltype(real.receiveFrom)>("recvfrom");
+    real.receiveMessage = next<decltype(real.receiveMessage)>("recvmsg");
+    real.poll = next<decltype(real.poll)>("poll");
+    real.nanosleep = next<decltype(real.nanosleep)>("nanosleep");
+    real.usleep = next<decltype(real.usleep)>("usleep");
+
+    void* frames[4];
+    backtrace(frames, 4);
+}
+#endif
+}
+
+namespace tests
+{
+
+int realtimeViolationCount() {
+    return numViolations.load();
+}
+
+ScopedExpectedRealtimeViolations::ScopedExpectedRealtimeViolations() : _previous(expectedViolations) {
+    expectedViolations = &_count;
+}
+
+ScopedExpectedRealtimeViolations::~ScopedExpectedRealtimeViolations() {
+    expectedViolations = _previous;
+}
+
+int ScopedExpectedRealtimeViolations::getCount() const {
+    return _count;
+}
+
+} // namespace tests
+
+#if MIDISENDER_INTERPOSE_LIBC
+
+//==============================================================================
+// Heap. operator new and delete end up here as well.
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void __libc_free(void*);
+
+void* malloc(size_t size) __THROW {
+    reportViolation("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) __THROW {
+    reportViolation("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) __THROW {
+    reportViolation("realloc");
+    return __libc_realloc(pointer, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) __THROW {
+    reportViolation("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) __THROW {
+    reportViolation("posix_memalign");
+    *pointer = __libc_memalign(alignment, size);
+    return *pointer != nullptr || size == 0 ? 0 : ENOMEM;
+}
+
+void free(void* pointer) __THROW {
+    if (pointer != nullptr)
+        reportViolation("free");
+    __libc_free(pointer);
+}
+
+//==============================================================================
+// Locks
+int pthread_mutex_lock(pthread_mutex_t* mutex) __THROWNL {
+    reportViolation("pthread_mutex_lock");
+    return real.mutexLock(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock) __THROWNL {
+    reportViolation("pthread_rwlock_rdlock");
+    return real.readLock(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock) __THROWNL {
+    reportViolation("pthread_rwlock_wrlock");
+    return real.writeLock(lock);
+}
+
+int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex) {
+    reportViolation("pthread_cond_wait");
+    return real.conditionWait(condition, mutex);
+}
+
+//==============================================================================
+// Blocking system calls
+ssize_t read(int fd, void* buffer, size_t size) {
+    reportViolation("read");
+    return real.read(fd, buffer, size);
+}
+
+ssize_t write(int fd, const void* buffer, size_t size) {
+    reportViolation("write");
+    return real.write(fd, buffer, size);
+}
+
+ssize_t send(int fd, const void* buffer, size_t size, int flags) {
+    reportViolation("send");
+    return real.send(fd, buffer, size, flags);
+}
+
+ssize_t sendto(int fd, const void* buffer, size_t size, int flags, const sockaddr* address, socklen_t addressSize) {
+    reportViolation("sendto");
+    return real.sendTo(fd, buffer, size, flags, address, addressSize);
+}
+
+ssize_t sendmsg(int fd, const msghdr* message, int flags) {
+    reportViolation("sendmsg");
+    return real.sendMessage(fd, message, flags);
+}
+
+ssize_t recv(int fd, void* buffer, size_t size, int flags) {
+    reportViolation("recv");
+    return real.receive(fd, buffer, size, flags);
+}
+
+ssize_t recvfrom(int fd, void* buffer, size_t size, int flags, sockaddr* address, socklen_t* addressSize) {
+    reportViolation("recvfrom");
+    return real.receiveFrom(fd, buffer, size, flags, address, addressSize);
+}
+
+ssize_t recvmsg(int fd, msghdr* message, int flags) {
+    reportViolation("recvmsg");
+    return real.receiveMessage(fd, message, flags);
+}
+
+int poll(pollfd* fds, nfds_t numFds, int timeout) {
+    reportViolation("poll");
+    return real.poll(fds, numFds, timeout);
+}
+
+int nanosleep(const timespec* duration, timespec* remaining) {
+    reportViolation("nanosleep");
+    return real.nanosleep(duration, remaining);
+}
+
+int usleep(useconds_t microseconds) {
+    reportViolation("usleep");
+    return real.usleep(microseconds);
+}
+}
+
+#else
+
+//==============================================================================
+// Without libc interposition, at least catch C++ allocations.
+void* operator new(std::size_t size) {
+    reportViolation("operator new");
+    if (auto* pointer = std::malloc(size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    if (pointer != nullptr)
+        reportViolation("operator delete");
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+#endif
@@ -0,0 +1,37 @@
+//
+//  RealtimeChecker.h
+//  MidiSender
+//
+//  Test-build instrumentation for MIDISENDER_REALTIME_SCOPE sections. On glibc
+//  the test binary interposes malloc/free, pthread locks and blocking syscalls;
+//  elsewhere only operator new/delete are caught. Every call made from inside
+//  a realtime section is printed with a stack trace and counted, and main()
+//  fails the test that caused it.
+//
+
+#pragma once
+
+namespace tests
+{
+
+/** Total number of violations reported so far, on any thread. */
+int realtimeViolationCount();
+
+/** For tests of the checker itself: violations on this thread are counted
+    here instead of being reported. */
+class ScopedExpectedRealtimeViolations {
+public:
+    ScopedExpectedRealtimeViolations();
+    ~ScopedExpectedRealtimeViolations();
+
+    ScopedExpectedRealtimeViolations(const ScopedExpectedRealtimeViolations&) = delete;
+    ScopedExpectedRealtimeViolations& operator=(const ScopedExpectedRealtimeViolations&) = delete;
+
+    int getCount() const;
+
+private:
+    int* _previous;
+    int _count = 0;
+};
+
+} // namespace tests
@@ -0,0 +1,218 @@
+//
+//  SoakMain.cpp
+//  MidiSender
+//
+//  Headless soak run: drives the BlockProcessor that
+//  OscSenderAudioProcessor::process() uses, minus the JUCE keyboard state,
+//  with synthetic MIDI at realtime pace. Sends to a local UDP sink that also
+//  answers clock pings (sent with --offline paced), and logs memory, block times and send failures until
+//  the time is up. --offline marks every block as part of an offline render
+//  sent in that mode (immediate, suppress, paced or file).
+//
+//      MidiSenderSoak [--seconds 43200] [--load "rate=500 chord=4 ..."]
+//                     [--log midisender-soak.log] [--interval-ms 10000]
+//                     [--block-size 256] [--sample-rate 48000]
+//                     [--max-rss-growth-kb 0] [--offline paced]
+//
+//  Exits non-zero on send failures, dropped events, a silent sink (unless
+//  suppressed), memory growth past the limit (0 = not checked) or, in
+//  instrumented builds, any realtime violation.
+//
+
+#include "Core/BlockProcessor.h"
+#include "Core/ClockSync.h"
+#include "Core/RealtimeCheck.h"
+
+#if defined(MIDISENDER_REALTIME_CHECKS)
+ #include "RealtimeChecker.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+
+using namespace midisender;
+
+namespace
+{
+struct Options {
+    double seconds = 12 * 60 * 60;
+    std::string load;
+    std::string logPath = "midisender-soak.log";
+    int intervalMs = 10000;
+    int blockSize = 256;
+    double sampleRate = 48000.0;
+    long maxResidentGrowthKb = 0;
+    bool isOffline = false;
+    OfflineMode offlineMode = DEFAULT_OFFLINE_MODE;
+};
+
+bool parseOfflineMode(const char* name, OfflineMode& mode) {
+    static constexpr std::pair<const char*, OfflineMode> modes[] = {
+        { "immediate", OfflineMode::sendImmediately },
+        { "suppress", OfflineMode::suppress },
+        { "paced", OfflineMode::paceToWallClock },
+        { "file", OfflineMode::writeToFile }
+    };
+    for (const auto& [modeName, value] : modes)
+        if (std::strcmp(name, modeName) == 0) {
+            mode = value;
+            return true;
+        }
+    return false;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* name = argv[i];
+        const char* value = argv[i + 1];
+        if (std::strcmp(name, "--seconds") == 0)
+            options.seconds = std::atof(value);
+        else if (std::strcmp(name, "--load") == 0)
+            options.load = value;
+        else if (std::strcmp(name, "--log") == 0)
+            options.logPath = value;
+        else if (std::strcmp(name, "--interval-ms") == 0)
+            options.intervalMs = std::atoi(value);
+        else if (std::strcmp(name, "--block-size") == 0)
+            options.blockSize = std::atoi(value);
+        else if (std::strcmp(name, "--sample-rate") == 0)
+            options.sampleRate = std::atof(value);
+        else if (std::strcmp(name, "--max-rss-growth-kb") == 0)
+            options.maxResidentGrowthKb = std::atol(value);
+        else if (std::strcmp(name, "--offline") == 0) {
+            if (! parseOfflineMode(value, options.offlineMode))
+                return false;
+            options.isOffline = true;
+        } else
+            return false;
+    }
+    return argc % 2 == 1 && options.seconds > 0.0 && options.blockSize > 0 && options.sampleRate > 0.0;
+}
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    LoadSettings settings;
+    std::string error;
+    if (! parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--seconds s] [--load settings] [--log path] [--interval-ms ms]\n"
+                             "       [--block-size n] [--sample-rate hz] [--max-rss-growth-kb kb]\n"
+                             "       [--offline immediate|suppress|paced|file]\n", argv[0]);
+        return 2;
+    }
+    if (! parseLoadSettings(options.load, settings, error)) {
+        std::fprintf(stderr, "invalid load setting: %s\n", error.c_str());
+        return 2;
+    }
+
+    ClockResponder sink;
+    if (! sink.bind(0)) {
+        std::fprintf(stderr, "could not bind the UDP sink\n");
+        return 1;
+    }
+    std::atomic<bool> running { true };
+    std::atomic<uint64_t> numReceived { 0 };
+    std::thread sinkThread([&] {
+        while (running)
+            sink.answerPending(100, [&](const OscMessageView&, uint64_t) { ++numReceived; });
+    });
+
+    OscEngine engine;
+    engine.setDestination("127.0.0.1", sink.getBoundPort());
+    engine.setClockSyncInterval(1000);
+    engine.setOfflineMode(options.offlineMode);
+    engine.setOfflineLogFolder(".");
+    std::vector<StreamedParameter> parameters;
+    for (int i = 0; i < NUM_MACRO_PARAMETERS; ++i)
+        parameters.push_back({ "macro" + std::to_string(i + 1), DEFAULT_PARAM_RATE_HZ, DEFAULT_PARAM_SMOOTHING_MS });
+    engine.setStreamedParameters(parameters);
+
+    MidiTransformStage transform;
+    transform.setSettings({});
+    LoadGenerator generator(settings);
+
+    SoakMonitor monitor;
+    monitor.setCounterSource([&] {
+        return SoakCounters { generator.getNumGenerated(), engine.getNumSent(), engine.getNumSendFailures(), engine.getNumDropped() };
+    });
+    if (! monitor.start(options.logPath, options.intervalMs)) {
+        std::fprintf(stderr, "could not write %s\n", options.logPath.c_str());
+        return 1;
+    }
+
+    BlockProcessor processor(engine, transform);
+    processor.setSoakTest(&generator, &monitor);
+
+    using Clock = std::chrono::steady_clock;
+    const auto blockDuration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.blockSize / options.sampleRate));
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+    auto nextBlock = start;
+    int64_t block = 0;
+
+    std::printf("soak: %.0f s to 127.0.0.1:%d, logging to %s\n", options.seconds, sink.getBoundPort(), options.logPath.c_str());
+    BlockContext context;
+    context.isNonRealtime = options.isOffline;
+    context.sampleRate = options.sampleRate;
+    while (nextBlock < end) {
+        {
+            MIDISENDER_REALTIME_SCOPE;
+            context.timeInSeconds = double(block * options.blockSize) / options.sampleRate;
+            processor.beginBlock(context);
+            for (int i = 0; i < NUM_MACRO_PARAMETERS; ++i)
+                processor.setParameterValue(i, float((block + i * 16) % 128) / 127.0f);
+            processor.endBlock(options.blockSize);
+        }
+
+        ++block;
+        nextBlock += blockDuration;
+        std::this_thread::sleep_until(nextBlock);
+    }
+
+    // A realtime block releases the held notes, which also ends an offline render
+    context.isNonRealtime = false;
+    context.timeInSeconds = double(block * options.blockSize) / options.sampleRate;
+    processor.beginBlock(context);
+    processor.releaseGeneratedNotes(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    monitor.stop();
+    running = false;
+    sinkThread.join();
+
+    const auto summary = monitor.getSummary();
+    const long growthKb = (long) summary.lastResidentKb - (long) summary.firstResidentKb;
+    std::printf("soak: %llu generated, %llu sent, %llu send failures, %llu dropped, %llu received\n",
+                (unsigned long long) summary.totals.generated,
+                (unsigned long long) summary.totals.sent,
+                (unsigned long long) summary.totals.sendFailures,
+                (unsigned long long) summary.totals.dropped,
+                (unsigned long long) numReceived.load());
+    std::printf("soak: rss %llu -> %llu kB (peak %llu), worst p99 %.1f us, worst block %.1f us\n",
+                (unsigned long long) summary.firstResidentKb,
+                (unsigned long long) summary.lastResidentKb,
+                (unsigned long long) summary.peakResidentKb,
+                summary.worstP99Us, summary.worstMaxUs);
+
+    const bool isSilent = options.isOffline && options.offlineMode != OfflineMode::sendImmediately
+                       && options.offlineMode != OfflineMode::paceToWallClock;
+    bool passed = summary.totals.sendFailures == 0 && summary.totals.dropped == 0 && (numReceived > 0 || isSilent);
+    if (options.maxResidentGrowthKb > 0 && growthKb > options.maxResidentGrowthKb) {
+        std::printf("soak: resident memory grew by %ld kB\n", growthKb);
+        passed = false;
+    }
+#if defined(MIDISENDER_REALTIME_CHECKS)
+    if (tests::realtimeViolationCount() > 0) {
+        std::printf("soak: %d realtime violations\n", tests::realtimeViolationCount());
+        passed = false;
+    }
+#endif
+    std::printf("soak: %s\n", passed ? "passed" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+//
+//  TestHarness.h
+//  MidiSender
+//
+//  Dependency-free test registry for the core library.
+//  Each TEST body registers itself; main() in TestMain.cpp runs them all.
+//
+
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace tests
+{
+
+struct TestCase {
+    const char* name;
+    std::function<void()> body;
+};
+
+inline std::vector<TestCase>& registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& failureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+struct Registrar {
+    Registrar(const char* name, std::function<void()> body) {
+        registry().push_back({ name, std::move(body) });
+    }
+};
+
+inline void reportFailure(const char* file, int line, const char* expression) {
+    std::fprintf(stderr, "  FAILED %s:%d: %s\n", file, line, expression);
+    ++failureCount();
+}
+
+} // namespace tests
+
+#define TEST_CONCAT_INNER(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_INNER(a, b)
+
+#define TEST(name) \
+    static void TEST_CONCAT(test_, name)(); \
+    static tests::Registrar TEST_CONCAT(registrar_, name)(#name, TEST_CONCAT(test_, name)); \
+    static void TEST_CONCAT(test_, name)()
+
+#define EXPECT(expression) \
+    do { if (! (expression)) tests::reportFailure(__FILE__, __LINE__, #expression); } while (false)
+
+#define REQUIRE(expression) \
+    do { if (! (expression)) { tests::reportFailure(__FILE__, __LINE__, #expression); return; } } while (false)
@@ -0,0 +1,38 @@
+//
+//  TestMain.cpp
+//  MidiSender
+//
+
+#include "TestHarness.h"
+
+#if defined(MIDISENDER_REALTIME_CHECKS)
+ #include "RealtimeChecker.h"
+#endif
+
+#include <cstring>
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int numRun = 0;
+
+    for (const auto& test : tests::registry()) {
+        if (filter != nullptr && std::strstr(test.name, filter) == nullptr)
+            continue;
+
+        const int failuresBefore = tests::failureCount();
+        std::printf("[ RUN  ] %s\n", test.name);
+#if defined(MIDISENDER_REALTIME_CHECKS)
+        const int violationsBefore = tests::realtimeViolationCount();
+        test.body();
+        if (tests::realtimeViolationCount() != violationsBefore)
+            tests::reportFailure(__FILE__, __LINE__, "no realtime violations");
+#else
+        test.body();
+#endif
+        std::printf("[ %s ] %s\n", tests::failureCount() == failuresBefore ? " OK " : "FAIL", test.name);
+        ++numRun;
+    }
+
+    std::printf("%d tests, %d failures\n", numRun, tests::failureCount());
+    return tests::failureCount() == 0 ? 0 : 1;
+}